@@ -0,0 +1,31 @@
+# Headless max build for benchmarks, noop entry instead of native window.
+add_library(max-noop STATIC ${MAX_SOURCES})
+
+foreach(
+	MAX_NOOP_PROPERTY
+	COMPILE_DEFINITIONS
+	INCLUDE_DIRECTORIES
+	LINK_LIBRARIES
+	INTERFACE_COMPILE_DEFINITIONS
+	INTERFACE_INCLUDE_DIRECTORIES
+	INTERFACE_LINK_LIBRARIES
+)
+	get_target_property(MAX_NOOP_VALUE max ${MAX_NOOP_PROPERTY})
+	if(MAX_NOOP_VALUE)
+		set_target_properties(max-noop PROPERTIES ${MAX_NOOP_PROPERTY} "${MAX_NOOP_VALUE}")
+	endif()
+endforeach()
+
+target_compile_definitions(max-noop PUBLIC "MAX_CONFIG_USE_NOOP=1")
+set_target_properties(max-noop PROPERTIES FOLDER "max/tests")
+
+file(
+	GLOB
+	MAX_BENCH_SOURCES #
+	${MAX_DIR}/tests/*_bench.cpp #
+	${MAX_DIR}/tests/*_bench.h #
+)
+add_executable(max-bench ${MAX_BENCH_SOURCES})
+target_link_libraries(max-bench PRIVATE max-noop)
+set_target_properties(max-bench PROPERTIES FOLDER "max/tests")
+add_test(NAME max.bench COMMAND max-bench --max 10000)
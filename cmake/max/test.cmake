@@ -0,0 +1,14 @@
+# Headless tests using Catch2 bundled with bx, linked against max-noop from
+# bench.cmake.
+file(
+	GLOB
+	MAX_TEST_SOURCES #
+	${BX_DIR}/3rdparty/catch/catch_amalgamated.cpp
+	${MAX_DIR}/tests/*_test.cpp #
+	${MAX_DIR}/tests/*.h #
+)
+add_executable(max-test ${MAX_TEST_SOURCES})
+target_compile_definitions(max-test PRIVATE CATCH_AMALGAMATED_CUSTOM_MAIN)
+target_link_libraries(max-test PRIVATE max-noop)
+set_target_properties(max-test PROPERTIES FOLDER "max/tests")
+add_test(NAME max.test COMMAND max-test)
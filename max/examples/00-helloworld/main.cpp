@@ -198,8 +198,8 @@ public:
 			max::System<RenderComponent, TransformComponent> renderer;
 			renderer.each(10, [](max::EntityHandle _entity, void* _userData)
 				{
-					RenderComponent* rc = max::getComponent<RenderComponent>(_entity);
-					TransformComponent* tc = max::getComponent<TransformComponent>(_entity);
+					RenderComponent* rc = max::getComponent<RenderComponent>(_entity, max::Access::Read);
+					TransformComponent* tc = max::getComponent<TransformComponent>(_entity, max::Access::Read);
 
 					max::MeshQuery* query = max::queryMesh(rc->m_mesh);
 
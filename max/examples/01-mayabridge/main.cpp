@@ -110,7 +110,7 @@ struct Scene
 						max::destroy(rc->m_material);
 					}
 					max::destroy(entity);
-					entity = MAX_INVALID_HANDLE;
+					entity = MAX_INVALID_HANDLE32;
 				}
 				else
 				{
@@ -160,7 +160,7 @@ struct Scene
 			if (isValid(entity))
 			{
 				// Update entity.
-				TransformComponent* tc = max::getComponent<TransformComponent>(entity);
+				TransformComponent* tc = max::getComponent<TransformComponent>(entity, max::Access::Write);
 				if (tc != NULL)
 				{
 					tc->m_position = {
@@ -192,7 +192,7 @@ struct Scene
 	struct EntityHandle
 	{
 		EntityHandle()
-			: m_handle(MAX_INVALID_HANDLE)
+			: m_handle(MAX_INVALID_HANDLE32)
 		{}
 
 		max::EntityHandle m_handle;
@@ -284,8 +284,8 @@ public:
 			max::System<RenderComponent, TransformComponent> renderer;
 			renderer.each(10, [](max::EntityHandle _entity, void* _userData)
 				{
-					RenderComponent* rc = max::getComponent<RenderComponent>(_entity);
-					TransformComponent* tc = max::getComponent<TransformComponent>(_entity);
+					RenderComponent* rc = max::getComponent<RenderComponent>(_entity, max::Access::Read);
+					TransformComponent* tc = max::getComponent<TransformComponent>(_entity, max::Access::Read);
 					
 					max::MeshQuery* query = max::queryMesh(rc->m_mesh);
 
@@ -276,6 +276,7 @@
 #define MAX_DEBUG_STATS                          UINT32_C(0x00000004) //!< Enable statistics display.
 #define MAX_DEBUG_TEXT                           UINT32_C(0x00000008) //!< Enable debug text display.
 #define MAX_DEBUG_PROFILER                       UINT32_C(0x00000010) //!< Enable profiler. This causes per-view statistics to be collected, available through `max::Stats::ViewStats`. This is unrelated to the profiler functions in `max::CallbackI`.
+#define MAX_DEBUG_PHYSICS                        UINT32_C(0x00000020) //!< Enable physics debug draw.
 
 #define MAX_BUFFER_COMPUTE_FORMAT_8X1            UINT16_C(0x0001) //!< 1 8-bit value
 #define MAX_BUFFER_COMPUTE_FORMAT_8X2            UINT16_C(0x0002) //!< 2 8-bit values
@@ -631,12 +632,14 @@
 #define MAX_BODY_ALLOW_ROTATION_X		UINT8_C(0b001000) //!< Body can rotate around world space X axis
 #define MAX_BODY_ALLOW_ROTATION_Y		UINT8_C(0b010000) //!< Body can rotate around world space Y axis
 #define MAX_BODY_ALLOW_ROTATION_Z		UINT8_C(0b100000) //!< Body can rotate around world space Z axis
+#define MAX_BODY_GROUND_QUERY			UINT8_C(0b1000000) //!< Evaluate ground state after each step while body is active, see `max::getGroundInfo`
 
 /// Body can move in X, Y and Z axis and only rotate around Z axis
 #define MAX_BODY_CHARACTER (0 \
 	| MAX_BODY_ALLOW_TRANSLATION_X \
 	| MAX_BODY_ALLOW_TRANSLATION_Y \
 	| MAX_BODY_ALLOW_TRANSLATION_Z \
+	| MAX_BODY_GROUND_QUERY \
 	) 
 
 /// Body can only move in X and Y axis and rotate around Z axis
@@ -10,6 +10,7 @@
 #include <stdint.h> // uint32_t
 #include <stdlib.h> // NULL
 #include <typeinfo> // typeid
+#include <utility>  // index_sequence
 
 #include <bx/bx.h>	   // macros
 #include <bx/hash.h>   // hash
@@ -43,6 +44,13 @@ extern "C" int _main_(int _argc, char** _argv);
 
 #define MAX_INVALID_HANDLE { max::kInvalidHandle }
 
+///
+#define MAX_HANDLE32(_name)                                                         \
+	struct _name { uint32_t idx; };                                                  \
+	inline bool isValid(_name _handle) { return max::kInvalidHandle32 != _handle.idx; }
+
+#define MAX_INVALID_HANDLE32 { max::kInvalidHandle32 }
+
 ///
 #define MAX_INPUT_BINDING_END { max::Key::None, max::Modifier::None, 0, NULL, NULL }
 #define MAX_INPUT_MAPPING_END { UINT32_MAX, NULL }
@@ -198,8 +206,10 @@ namespace max
 	{
 		enum Enum
 		{
-			NonMoving, //!< Non moving only collides with moving
-			Moving,    //!< Moving collides with everything
+			NonMoving, //!< Non moving only collides with moving and debris
+			Moving,    //!< Moving collides with everything except debris
+			Debris,    //!< Debris only collides with non moving
+			Trigger,   //!< Trigger only collides with moving
 
 			Count
 		};
@@ -223,6 +233,9 @@ namespace max
 			Sphere,
 			Box,
 			Capsule,
+			Mesh,        //!< Triangle mesh, static and kinematic bodies only.
+			ConvexHull,  //!< Convex hull of mesh vertices.
+			HeightField, //!< Height field sampled from mesh vertices on XZ grid, static bodies only.
 
 			Count
 		};
@@ -240,6 +253,31 @@ namespace max
 		};
 	};
 
+	/// Physics state snapshot mode.
+	struct PhysicsState
+	{
+		enum Enum
+		{
+			All,    //!< Save all bodies, contacts and constraints.
+			Active, //!< Save active bodies and their contacts only, sleeping bodies keep their state on restore.
+
+			Count
+		};
+	};
+
+	/// Asynchronous load state.
+	struct LoadState
+	{
+		enum Enum
+		{
+			Pending, //!< Asset is being loaded, placeholder is used.
+			Ready,   //!< Asset is loaded.
+			Failed,  //!< Asset failed to load, placeholder is kept.
+
+			Count
+		};
+	};
+
 	/// Texture format enum.
 	///
 	/// Notation:
@@ -707,6 +745,7 @@ namespace max
 	};
 
 	static const uint16_t kInvalidHandle = UINT16_MAX;
+	static const uint32_t kInvalidHandle32 = UINT32_MAX;
 
 	MAX_HANDLE(DynamicIndexBufferHandle)
 	MAX_HANDLE(DynamicVertexBufferHandle)
@@ -723,8 +762,9 @@ namespace max
 	MAX_HANDLE(WindowHandle)
 	MAX_HANDLE(GamepadHandle)
 	MAX_HANDLE(MeshHandle)
-	MAX_HANDLE(ComponentHandle)
-	MAX_HANDLE(EntityHandle)
+	MAX_HANDLE32(ComponentHandle)
+	MAX_HANDLE(ComponentTypeHandle)
+	MAX_HANDLE32(EntityHandle)
 	MAX_HANDLE(BodyHandle)
 		//MAX_HANDLE(TrueTypeHandle)		 
 		//MAX_HANDLE(FontHandle)			 
@@ -1016,10 +1056,37 @@ namespace max
 			uint32_t minResourceCbSize; //!< Minimum resource command buffer size.
 			uint32_t transientVbSize;   //!< Maximum transient vertex buffer size.
 			uint32_t transientIbSize;   //!< Maximum transient index buffer size.
+			uint32_t entityPoolSize;    //!< Initial entity pool size, grows on demand.
+			uint32_t componentPoolSize; //!< Initial component pool size, grows on demand.
+			uint32_t asyncUploadBudget; //!< Bytes of asynchronously loaded assets uploaded per frame.
 		};
 
 		Limits limits; //!< Configurable runtime limits.
 
+		/// Physics simulation parameters.
+		///
+		struct Physics
+		{
+			Physics();
+
+			uint16_t stepRate;              //!< Fixed simulation rate in Hz.
+			uint8_t  maxSubsteps;           //!< Maximum number of fixed steps per frame.
+			uint8_t  collisionSteps;        //!< Number of collision steps per fixed step.
+			uint8_t  numThreads;            //!< Number of physics worker threads, `UINT8_MAX` to use all but one core.
+			uint32_t tempAllocatorSize;     //!< Size of per step temporary allocator.
+			uint32_t maxBodies;             //!< Maximum number of bodies, at most `MAX_CONFIG_MAX_BODIES`.
+			uint32_t maxBodyPairs;          //!< Maximum number of body pairs found by broadphase per step.
+			uint32_t maxContactConstraints; //!< Maximum number of contact constraints per step.
+			uint32_t numBodyMutexes;        //!< Number of body mutexes, 0 for default.
+			float    gravity[3];            //!< Gravity.
+
+			/// Mask of layers each layer collides with, bit `1<<LayerType::Enum`.
+			/// Layer pairs collide if either layer has other layer in its mask.
+			uint8_t  layerMask[LayerType::Count];
+		};
+
+		Physics physics; //!< Physics simulation parameters.
+
 		/// Provide application specific callback interface.
 		/// See: `max::CallbackI`
 		CallbackI* callback;
@@ -1263,6 +1330,81 @@ namespace max
 		bx::Vec3 m_velocity;
 	};
 
+	/// Contact state.
+	///
+	struct ContactState
+	{
+		enum Enum
+		{
+			Added,     //!< Bodies started touching.
+			Persisted, //!< Bodies are still touching.
+			Removed,   //!< Bodies stopped touching.
+
+			Count
+		};
+	};
+
+	/// Physics contact event.
+	///
+	struct ContactEvent
+	{
+		ContactEvent()
+			: m_state(ContactState::Added)
+			, m_position({ 0.0f, 0.0f, 0.0f })
+			, m_normal({ 0.0f, 0.0f, 0.0f })
+			, m_depth(0.0f)
+		{
+			m_body0.idx = UINT16_MAX;
+			m_body1.idx = UINT16_MAX;
+		}
+
+		ContactState::Enum m_state;
+		BodyHandle m_body0;
+		BodyHandle m_body1;
+		bx::Vec3   m_position; //!< World space contact position, not set for `ContactState::Removed`.
+		bx::Vec3   m_normal;   //!< World space contact normal from `m_body0` to `m_body1`, not set for `ContactState::Removed`.
+		float      m_depth;    //!< Penetration depth, not set for `ContactState::Removed`.
+	};
+
+	/// Physics body activation event.
+	///
+	struct ActivationEvent
+	{
+		BodyHandle m_body;
+		bool       m_active; //!< True if body woke up, false if it went to sleep.
+	};
+
+	/// Physics ray, or shape sweep, from `m_origin` to `m_origin + m_direction`.
+	///
+	struct PhysicsRay
+	{
+		PhysicsRay()
+			: m_origin({ 0.0f, 0.0f, 0.0f })
+			, m_direction({ 0.0f, 0.0f, 0.0f })
+		{}
+
+		bx::Vec3 m_origin;    //!< Start position.
+		bx::Vec3 m_direction; //!< Direction scaled by length.
+	};
+
+	/// Physics ray or shape sweep hit.
+	///
+	struct PhysicsHit
+	{
+		PhysicsHit()
+			: m_fraction(1.0f)
+			, m_position({ 0.0f, 0.0f, 0.0f })
+			, m_normal({ 0.0f, 0.0f, 0.0f })
+		{
+			m_body.idx = UINT16_MAX;
+		}
+
+		BodyHandle m_body;     //!< Body hit, invalid handle if nothing was hit.
+		float      m_fraction; //!< Fraction of direction at hit, in range [0, 1].
+		bx::Vec3   m_position; //!< World space hit position.
+		bx::Vec3   m_normal;   //!< World space surface normal of body hit.
+	};
+
 	/// Frame buffer texture attachment info.
 	///
 	struct Attachment
@@ -1376,6 +1518,33 @@ namespace max
 		int64_t cpuTimeEnd;   //!< Encoder thread CPU submit end time.
 	};
 
+	/// Physics stats, for fixed steps published this frame.
+	///
+	struct PhysicsStats
+	{
+		int64_t  cpuTimeStep;            //!< Physics thread CPU time spent in fixed steps.
+		int64_t  cpuTimeGround;          //!< Part of step time spent in ground queries after simulation.
+		uint32_t numSteps;               //!< Number of fixed steps.
+		uint32_t numBodies;              //!< Number of bodies.
+		uint32_t numActiveBodies;        //!< Number of active bodies.
+		uint32_t numContactConstraints;  //!< Number of contact constraints in last step.
+		uint32_t tempAllocatorHighWater; //!< Peak temporary allocator usage since init.
+		bool     bodyPairsFull;          //!< Body pair limit was hit, some contacts were ignored.
+		bool     contactConstraintsFull; //!< Contact constraint limit was hit, some contacts were ignored.
+	};
+
+	/// ECS stats, since last `max::frame` call.
+	///
+	struct EcsStats
+	{
+		uint32_t numEntities;       //!< Number of entities.
+		uint32_t numComponents;     //!< Number of components.
+		uint32_t numArchetypes;     //!< Number of archetypes.
+		uint32_t queryMemoryUsed;   //!< Query result memory used.
+		uint32_t queryMemoryMax;    //!< Query result memory available without heap allocation.
+		uint32_t numQueryOverflows; //!< Number of heap allocations for query results.
+	};
+
 	/// Renderer statistics data.
 	///
 	/// @remarks All time values are high-resolution timestamps, while
@@ -1433,6 +1602,9 @@ namespace max
 
 		uint8_t       numEncoders;          //!< Number of encoders used during frame.
 		EncoderStats* encoderStats;         //!< Array of encoder stats.
+
+		PhysicsStats physics;               //!< Physics stats.
+		EcsStats     ecs;                   //!< ECS stats.
 	};
 
 	/// Encoders are used for submitting draw calls from multiple threads. Only one encoder
@@ -2327,6 +2499,10 @@ namespace max
 
 	/// Entity query.
 	///
+	/// @remarks
+	///   Results returned by query functions are owned by max and must not
+	///   be freed.
+	///
 	struct EntityQuery
 	{
 		void alloc(uint32_t _num);
@@ -2336,8 +2512,26 @@ namespace max
 		EntityHandle* m_entities; //!< List of queried entity handles.
 	};
 
+	/// Chunk query.
+	///
+	/// Entities with same set of components are stored together in chunks,
+	/// with one tightly packed array per component type.
+	///
+	struct ChunkQuery
+	{
+		uint32_t m_num;             //!< Number of queried chunks.
+		uint32_t m_numComponents;   //!< Number of component arrays per chunk.
+		uint32_t* m_numEntities;    //!< Number of entities in each chunk.
+		EntityHandle** m_entities;  //!< Entity handles of each chunk.
+		void** m_components;        //!< Component arrays, `m_numComponents` per chunk in query order.
+	};
+
 	/// Hash query.
 	///
+	/// @remarks
+	///   Hash based queries are meant for tooling, templated API uses component
+	///   type ids.
+	///
 	struct HashQuery
 	{
 		void alloc(uint32_t _num);
@@ -2347,6 +2541,71 @@ namespace max
 		uint32_t* m_data;
 	};
 
+	/// Register component type.
+	///
+	/// @param[in] _hash Unique id to identify component type.
+	/// @param[in] _size Size of component, zero if unknown.
+	/// @returns Dense component type id. Registering same hash again returns
+	///   the same id.
+	///
+	ComponentTypeHandle registerComponentType(uint32_t _hash, uint32_t _size);
+
+	/// Returns component type id of `T`. Type is registered on first use and
+	/// id is cached, so no hashing is done afterwards.
+	///
+	template<typename T>
+	ComponentTypeHandle getComponentType()
+	{
+		static const ComponentTypeHandle s_type = registerComponentType(bx::hash<bx::HashMurmur2A>(typeid(T).name() ), sizeof(T) );
+		return s_type;
+	}
+
+	/// Query entities that have all component types.
+	///
+	/// @param[in] _types Component types.
+	/// @param[in] _num Number of component types.
+	/// @returns Entity query.
+	///
+	/// @remarks
+	///   Query results are allocated from per frame arena, each call returns
+	///   its own result which is valid until next `max::frame` call. Results
+	///   can be held while other queries run on other threads.
+	///
+	EntityQuery* queryEntities(const ComponentTypeHandle* _types, uint32_t _num);
+
+	///
+	EntityQuery* queryEntities(const HashQuery& _hashes);
+
+	/// Query entities that have all component types, and where any of listed
+	/// components was changed in or after frame `_sinceFrame`.
+	///
+	/// @param[in] _types Component types.
+	/// @param[in] _num Number of component types.
+	/// @param[in] _sinceFrame Frame number, usually value returned by
+	///   `max::frame` the last time system ran. Zero returns all entities.
+	///
+	/// @remarks
+	///   Component is changed when it's added, accessed with write access
+	///   through `getComponent`, or marked with `markChanged`. Entities
+	///   changed after system ran in the same frame are returned again next
+	///   time. See `queryEntities` for lifetime of query results.
+	///
+	EntityQuery* queryChangedEntities(const ComponentTypeHandle* _types, uint32_t _num, uint32_t _sinceFrame);
+
+	/// Query archetype chunks containing all component types.
+	///
+	/// @param[in] _types Component types.
+	/// @param[in] _num Number of component types.
+	/// @returns Chunk query, component arrays are in same order as `_types`.
+	///
+	/// @remarks
+	///   See `queryEntities` for lifetime of query results.
+	///
+	ChunkQuery* queryChunks(const ComponentTypeHandle* _types, uint32_t _num);
+
+	///
+	ChunkQuery* queryChunks(const HashQuery& _hashes);
+
 	/// System for each entity callback.
 	///
 	/// param[in] _entity Current entity in loop.
@@ -2354,25 +2613,88 @@ namespace max
 	///
 	typedef void (*SystemFn)(EntityHandle _entity, void* _userData);
 
+	/// System for each entity callback, executed on worker thread.
+	///
+	/// param[in] _encoder Encoder owned by current worker thread.
+	/// param[in] _entity Current entity in loop.
+	/// param[in] _userData User defined data if needed.
+	///
+	typedef void (*SystemParallelFn)(Encoder* _encoder, EntityHandle _entity, void* _userData);
+
+	/// Run callback for entities across worker threads. Each range of entities
+	/// is processed with its own encoder.
+	///
+	/// @param[in] _entities Entity handles.
+	/// @param[in] _num Number of entities.
+	/// @param[in] _func Callback.
+	/// @param[in] _userData User defined data if needed.
+	/// @param[in] _grain Minimum number of entities per worker.
+	///
+	/// @remarks
+	///   Calling thread's encoder is acquired first, ranges that can't get
+	///   encoder of their own run on calling thread with it. When called
+	///   from thread other than API thread and no encoder is free, nothing
+	///   is executed.
+	///
+	void parallelEach(const EntityHandle* _entities, uint32_t _num, SystemParallelFn _func, void* _userData, uint32_t _grain);
+
 	/// Entity system.
 	///
 	template<typename... Components>
 	struct System
 	{
+		static_assert(sizeof...(Components) > 0, "System requires at least one component type.");
+
+		/// System for each chunk callback.
+		///
+		/// param[in] _num Number of entities in chunk.
+		/// param[in] _entities Entity handles in chunk.
+		/// param[in] _components Component arrays, `_num` elements each.
+		/// param[in] _userData User defined data if needed.
+		///
+		typedef void (*ChunkFn)(uint32_t _num, const EntityHandle* _entities, Components*... _components, void* _userData);
+
 		System()
 			: m_num(0)
 		{}
 
 		uint32_t m_num;
 
+		/// Iterate over component arrays of all matching chunks.
+		///
+		/// @remarks
+		///   Components must not be added or removed while iterating. Writes
+		///   are not tracked, use `markChanged` for change tracking.
+		///
+		void eachChunk(ChunkFn _func, void* _userData = NULL)
+		{
+			const ComponentTypeHandle types[] = { getComponentType<Components>()... };
+
+			const ChunkQuery* qr = queryChunks(types, sizeof...(Components) );
+
+			m_num = 0;
+
+			for (uint32_t ii = 0; ii < qr->m_num; ++ii)
+			{
+				invokeChunk(std::index_sequence_for<Components...>{}
+					, _func
+					, qr->m_numEntities[ii]
+					, qr->m_entities[ii]
+					, &qr->m_components[ii*qr->m_numComponents]
+					, _userData
+					);
+
+				m_num += qr->m_numEntities[ii];
+			}
+		}
+
 		void each(uint32_t _max, SystemFn _func, void* _userData = NULL)
 		{
-			HashQuery m_query;
-			m_query.alloc(_max);
+			BX_UNUSED(_max);
 
-			(hashComponentType<Components>(m_query), ...);
+			const ComponentTypeHandle types[] = { getComponentType<Components>()... };
 
-			EntityQuery* qr = queryEntities(m_query);
+			EntityQuery* qr = queryEntities(types, sizeof...(Components) );
 			if (qr == NULL)
 			{
 				return;
@@ -2384,19 +2706,63 @@ namespace max
 			{
 				_func(qr->m_entities[ii], _userData);
 			}
+		}
+
+		/// Iterate over matching entities on worker threads.
+		///
+		/// @remarks
+		///   Callback receives encoder owned by its worker thread, use it for
+		///   submitting draws instead of global functions. Components must not
+		///   be added or removed while iterating.
+		///
+		void eachParallel(uint32_t _max, SystemParallelFn _func, void* _userData = NULL, uint32_t _grain = 64)
+		{
+			BX_UNUSED(_max);
 
-			m_query.free();
+			const ComponentTypeHandle types[] = { getComponentType<Components>()... };
+
+			EntityQuery* qr = queryEntities(types, sizeof...(Components) );
+			if (qr == NULL)
+			{
+				return;
+			}
+
+			m_num = qr->m_num;
+
+			parallelEach(qr->m_entities, qr->m_num, _func, _userData, _grain);
+		}
+
+		/// Iterate over matching entities where any of system components
+		/// was changed in or after frame `_sinceFrame`.
+		///
+		/// @remarks
+		///   See `queryChangedEntities`.
+		///
+		void eachChanged(uint32_t _sinceFrame, SystemFn _func, void* _userData = NULL)
+		{
+			const ComponentTypeHandle types[] = { getComponentType<Components>()... };
+
+			EntityQuery* qr = queryChangedEntities(types, sizeof...(Components), _sinceFrame);
+			if (qr == NULL)
+			{
+				return;
+			}
+
+			m_num = qr->m_num;
+
+			for (uint32_t ii = 0; ii < qr->m_num; ++ii)
+			{
+				_func(qr->m_entities[ii], _userData);
+			}
 		}
 
 		// @todo first() ?
 
 	private:
-		template<typename T>
-		void hashComponentType(HashQuery& _hashes)
+		template<size_t... Indices>
+		static void invokeChunk(std::index_sequence<Indices...>, ChunkFn _func, uint32_t _num, const EntityHandle* _entities, void* const* _components, void* _userData)
 		{
-			uint32_t hash = bx::hash<bx::HashMurmur2A>(typeid(T).name());
-			_hashes.m_data[_hashes.m_num] = hash;
-			++_hashes.m_num;
+			_func(_num, _entities, (Components*)_components[Indices]..., _userData);
 		}
 	};
 
@@ -3728,6 +4094,30 @@ namespace max
 		Orientation::Enum* _orientation = NULL
 	);
 
+	/// Load texture from path asynchronously.
+	///
+	/// @param[in] _filePath Path to texture.
+	/// @param[in] _flags Texture creation and sampler flags, see `max::loadTexture`.
+	/// @param[in] _skip Skip top level mips when parsing texture.
+	/// @returns Texture handle.
+	///
+	/// @remarks
+	///   Returned handle is immediately usable, it refers to 1x1 placeholder
+	///   texture until file is read and decoded on I/O thread and uploaded
+	///   within per frame upload budget (see `Init::Limits::asyncUploadBudget`).
+	///   Texture can't be updated while it's loading.
+	///
+	TextureHandle loadTextureAsync(
+		const char* _filePath,
+		uint64_t _flags = MAX_TEXTURE_NONE | MAX_SAMPLER_NONE,
+		uint8_t _skip = 0
+	);
+
+	/// Returns load state of texture, textures not created by `max::loadTextureAsync`
+	/// are always ready.
+	///
+	LoadState::Enum getLoadState(TextureHandle _handle);
+
 	///// @todo Add comment
 	bimg::ImageContainer* loadImage(const char* _filePath, TextureFormat::Enum _dstFormat);
 
@@ -4123,11 +4513,51 @@ namespace max
 	///
 	/// @remarks
 	///   Mesh binary is obtained by compiling mesh offline with geometryc command line tool.
+	///   File is memory mapped and uncompressed vertex and index data is passed to renderer
+	///   without intermediate copies.
 	///
 	MeshHandle loadMesh(const char* _filePath, bool _ramcopy = false);
 
-	/// 
-	MeshQuery* queryMesh(MeshHandle _handle);
+	/// Load mesh from path asynchronously.
+	///
+	/// @param[in] _filePath Path of the geometry binary.
+	/// @param[in] _ramcopy Should copy the memory.
+	/// @returns Mesh handle.
+	///
+	/// @remarks
+	///   Returned handle is immediately usable, mesh has no groups until file
+	///   is read and decoded on I/O thread and uploaded within per frame upload
+	///   budget (see `Init::Limits::asyncUploadBudget`).
+	///
+	MeshHandle loadMeshAsync(const char* _filePath, bool _ramcopy = false);
+
+	/// Returns load state of mesh, meshes not created by `max::loadMeshAsync`
+	/// are always ready.
+	///
+	LoadState::Enum getLoadState(MeshHandle _handle);
+
+	/// Query vertex and index buffers of mesh groups.
+	///
+	/// @param[in] _handle Mesh handle.
+	/// @param[in] _lod Level of detail, 0 is full detail. Groups with fewer LODs
+	///   return their last LOD. RAM copy of indices is available for LOD 0 only.
+	///
+	MeshQuery* queryMesh(MeshHandle _handle, uint8_t _lod = 0);
+
+	/// Returns coarsest LOD of mesh whose simplification error projects to at
+	/// most `_threshold` pixels.
+	///
+	/// @param[in] _handle Mesh handle.
+	/// @param[in] _distance Distance from camera to mesh in object space units.
+	/// @param[in] _projScale Pixels per unit at distance 1, for perspective projection
+	///   `proj[5] * viewHeight * 0.5f`.
+	/// @param[in] _threshold Maximum error in pixels.
+	/// @returns LOD to pass to `max::queryMesh`, 0 is full detail.
+	///
+	/// @remarks
+	///   LODs are generated offline with geometryc `--lod` option.
+	///
+	uint8_t getMeshLod(MeshHandle _handle, float _distance, float _projScale, float _threshold = 1.0f);
 
 	/// 
 	const max::VertexLayout getLayout(MeshHandle _handle);
@@ -4176,15 +4606,68 @@ namespace max
 	///
 	EntityHandle createEntity(bool _destroyComponents = true);
 
+	/// Entity prototype, set of component types with initial data used to
+	/// instantiate entities in bulk.
+	///
+	/// @remarks
+	///   Prototype references component data, it must stay valid until
+	///   `max::createEntities` returns.
+	///
+	struct EntityPrototype
+	{
+		enum { MaxComponents = 64 };
+
+		///
+		EntityPrototype();
+
+		/// Start adding components.
+		EntityPrototype& begin();
+
+		/// Add component type with initial data. Data can be NULL.
+		EntityPrototype& add(ComponentTypeHandle _type, const void* _data, uint32_t _size);
+
+		///
+		template<typename T>
+		EntityPrototype& add(const T& _data)
+		{
+			return add(getComponentType<T>(), &_data, sizeof(T) );
+		}
+
+		uint32_t m_num;
+		ComponentTypeHandle m_types[MaxComponents];
+		const void* m_data[MaxComponents];
+		uint32_t m_size[MaxComponents];
+	};
+
+	/// Create entities in bulk from prototype. Entities and their components
+	/// are allocated with single lock, into contiguous archetype storage.
+	///
+	/// @param[in] _num Number of entities.
+	/// @param[in] _prototype Component types and initial data.
+	/// @param[in] _destroyComponents If true, components will be destroyed when
+	///   entity is destroyed.
+	/// @returns First entity handle, created entities have `_num` consecutive
+	///   handles starting from it.
+	///
+	EntityHandle createEntities(uint32_t _num, const EntityPrototype& _prototype, bool _destroyComponents = true);
+
+	/// Add component to entity.
+	///
+	/// @param[in] _entity Entity that should own component.
+	/// @param[in] _component Component to add.
+	/// @param[in] _type Component type, see `registerComponentType`.
+	///
+	void addComponent(EntityHandle _entity, ComponentHandle _component, ComponentTypeHandle _type);
+
 	/// Add component to entity.
-	/// @todo Make it so this doesnt need hash as input. Hash of component type can be stored per component?
 	///
 	/// @param[in] _entity Entity that should own component.
 	/// @param[in] _component Component to add.
 	/// @param[in] _hash Unique id to identify component type.
 	/// 
 	/// @remarks
-	///   It's prefered that templated functions are used for automated hash control.
+	///   It's prefered that templated functions are used, hash variant is
+	///   meant for tooling.
 	///
 	void addComponent(EntityHandle _entity, ComponentHandle _component, uint32_t _hash);
 
@@ -4192,30 +4675,154 @@ namespace max
 	template<typename T>
 	void addComponent(EntityHandle _entity, ComponentHandle _component)
 	{
-		uint32_t hash = bx::hash<bx::HashMurmur2A>(typeid(T).name());
-		addComponent(_entity, _component, hash);
+		addComponent(_entity, _component, getComponentType<T>() );
 	}
 
-	/// 
-	void* getComponent(EntityHandle _handle, uint32_t _hash);
+	/// Get component data of entity.
+	///
+	/// @param[in] _handle Entity handle.
+	/// @param[in] _type Component type.
+	/// @param[in] _access Access mode. Any mode except `Access::Read` marks
+	///   component as changed in current frame, writers must request it.
+	///
+	/// @remarks
+	///   Returned pointer points into archetype chunk and is invalidated when
+	///   components are added to or removed from any entity.
+	///   Safe to call from parallel systems, as long as no entities are
+	///   created or destroyed and no components are added or removed while
+	///   they run. Use `max::beginEntityCommands` for structural changes
+	///   inside of systems. Temporary entity command buffer handles are not
+	///   valid here.
+	///
+	void* getComponent(EntityHandle _handle, ComponentTypeHandle _type, Access::Enum _access = Access::Read);
+
+	/// Get component data of entity by component type hash.
+	///
+	/// @param[in] _handle Entity handle.
+	/// @param[in] _hash Component type hash.
+	/// @param[in] _access Access mode, see `getComponent`.
+	///
+	/// @remarks
+	///   Hash variant is meant for tooling.
+	///
+	void* getComponent(EntityHandle _handle, uint32_t _hash, Access::Enum _access = Access::Read);
 
 	///
 	template<typename T>
-	T* getComponent(EntityHandle _entity)
+	T* getComponent(EntityHandle _entity, Access::Enum _access = Access::Read)
 	{
-		uint32_t hash = bx::hash<bx::HashMurmur2A>(typeid(T).name());
-		return (T*)getComponent(_entity, hash);
+		return (T*)getComponent(_entity, getComponentType<T>(), _access);
 	}
 
+	/// Mark component of entity as changed in current frame. Use after
+	/// writing through pointers obtained with read access or `eachChunk`.
 	///
-	EntityQuery* queryEntities(const HashQuery& _hashes);
+	/// @param[in] _entity Entity handle.
+	/// @param[in] _type Component type.
+	///
+	void markChanged(EntityHandle _entity, ComponentTypeHandle _type);
+
+	///
+	template<typename T>
+	void markChanged(EntityHandle _entity)
+	{
+		markChanged(_entity, getComponentType<T>() );
+	}
+
+	/// Remove component from entity. If entity was created with
+	/// `_destroyComponents` component is destroyed, otherwise it's detached
+	/// and can be added to another entity.
+	///
+	/// @param[in] _entity Entity handle.
+	/// @param[in] _type Component type.
+	///
+	void removeComponent(EntityHandle _entity, ComponentTypeHandle _type);
+
+	/// Remove component from entity by component type hash.
+	///
+	/// @remarks
+	///   Hash variant is meant for tooling.
+	///
+	void removeComponent(EntityHandle _entity, uint32_t _hash);
+
+	///
+	template<typename T>
+	void removeComponent(EntityHandle _entity)
+	{
+		removeComponent(_entity, getComponentType<T>() );
+	}
 
 	/// Destroy entity.
 	///
 	/// @param[in] _handle Handle to component object.
 	///
+	/// @remarks
+	///   Handle of destroyed entity is not reused before next `max::frame`
+	///   call.
+	///
 	void destroy(EntityHandle _entity);
 
+	/// Destroy `_num` entities with consecutive handles, as returned by
+	/// `max::createEntities`.
+	///
+	/// @param[in] _first First entity handle.
+	/// @param[in] _num Number of entities.
+	///
+	void destroy(EntityHandle _first, uint32_t _num);
+
+	/// Entity command buffer. Records structural changes without touching
+	/// entity storage, changes are played back on next `max::frame` call.
+	///
+	/// @remarks
+	///   Each thread should use its own command buffer. Entities created
+	///   through command buffer get temporary handles that are only valid
+	///   for commands recorded in the same command buffer.
+	///
+	struct EntityCommandBuffer
+	{
+		/// Record entity creation.
+		///
+		/// @returns Temporary entity handle.
+		///
+		EntityHandle createEntity(bool _destroyComponents = true);
+
+		/// Record entity destruction.
+		void destroy(EntityHandle _entity);
+
+		/// Record adding component with initial data to entity.
+		void addComponent(EntityHandle _entity, ComponentTypeHandle _type, const void* _data, uint32_t _size);
+
+		///
+		template<typename T>
+		void addComponent(EntityHandle _entity, const T& _data = T() )
+		{
+			addComponent(_entity, getComponentType<T>(), &_data, sizeof(T) );
+		}
+
+		/// Record removing component from entity.
+		void removeComponent(EntityHandle _entity, ComponentTypeHandle _type);
+
+		///
+		template<typename T>
+		void removeComponent(EntityHandle _entity)
+		{
+			removeComponent(_entity, getComponentType<T>() );
+		}
+	};
+
+	/// Begin recording entity commands.
+	///
+	/// @returns Entity command buffer, or NULL if all command buffers are in use.
+	///
+	EntityCommandBuffer* beginEntityCommands();
+
+	/// End recording entity commands, queue them for playback on next
+	/// `max::frame` call. Command buffer can be ended only once.
+	///
+	/// @param[in] _commands Entity command buffer from `max::beginEntityCommands`.
+	///
+	void end(EntityCommandBuffer* _commands);
+
 	/// 
 	BodyHandle createBody(
 		CollisionShape::Enum _shape,
@@ -4229,6 +4836,42 @@ namespace max
 		uint8_t _flags = MAX_BODY_ALLOW_ALL
 	);
 
+	/// Create body with collision shape built from mesh.
+	///
+	/// @param[in] _shape Shape type, `CollisionShape::Mesh`, `CollisionShape::ConvexHull`
+	///   or `CollisionShape::HeightField`.
+	/// @param[in] _mesh Mesh created with `_ramcopy` enabled.
+	/// @param[in] _pos Position.
+	/// @param[in] _quat Rotation.
+	/// @param[in] _scale Scale applied to mesh.
+	/// @param[in] _layer Layer type.
+	/// @param[in] _motion Motion type. `CollisionShape::Mesh` can't be dynamic,
+	///   and `CollisionShape::HeightField` must be static.
+	/// @param[in] _activation Activation.
+	/// @param[in] _maxVelocity Maximum velocity.
+	/// @param[in] _flags Body flags, see `MAX_BODY_*`.
+	///
+	/// @returns Handle to body, invalid if mesh has no RAM copy, motion type
+	///   is not supported by shape, collision shape can't be built, or
+	///   `Init::Physics::maxBodies` is reached.
+	///
+	/// @remarks
+	///   Collision shapes are cached per mesh and shape type, bodies created
+	///   from same mesh share single shape.
+	///
+	BodyHandle createBody(
+		CollisionShape::Enum _shape,
+		MeshHandle _mesh,
+		const bx::Vec3& _pos,
+		const bx::Quaternion& _quat,
+		const bx::Vec3& _scale,
+		LayerType::Enum _layer,
+		MotionType::Enum _motion,
+		Activation::Enum _activation,
+		float _maxVelocity = 500.0f,
+		uint8_t _flags = MAX_BODY_ALLOW_ALL
+	);
+
 	///
 	BodyHandle createBodySphere(
 		const bx::Vec3& _pos,
@@ -4266,6 +4909,12 @@ namespace max
 		uint8_t _flags = MAX_BODY_ALLOW_ALL
 		);
 
+	/// Set body position.
+	///
+	/// @remarks
+	///   While fixed step batch is simulated on physics thread, body writes
+	///   are queued and applied once batch is done. Getters return state
+	///   without queued writes until then.
 	///
 	void setPosition(BodyHandle _handle, const bx::Vec3& _pos, Activation::Enum _activation);
 
@@ -4321,6 +4970,113 @@ namespace max
 	///
 	void addMovement(BodyHandle _handle, const bx::Vec3& _position, const bx::Quaternion& _rotation, const float _deltaTime);
 
+	/// Retrieve positions and rotations of multiple bodies at once.
+	///
+	/// @param[in] _handles Body handles.
+	/// @param[in] _num Number of bodies.
+	/// @param[out] _positions Array of `_num` positions, can be NULL.
+	/// @param[out] _rotations Array of `_num` rotations, can be NULL.
+	///
+	void getBodyTransforms(
+		const BodyHandle* _handles
+		, uint32_t _num
+		, bx::Vec3* _positions
+		, bx::Quaternion* _rotations
+		);
+
+	/// Set positions of multiple bodies at once.
+	///
+	/// @param[in] _handles Body handles.
+	/// @param[in] _num Number of bodies.
+	/// @param[in] _positions Array of `_num` positions.
+	/// @param[in] _activation Activation mode.
+	///
+	void setPositions(
+		const BodyHandle* _handles
+		, uint32_t _num
+		, const bx::Vec3* _positions
+		, Activation::Enum _activation
+		);
+
+	/// Add forces to multiple bodies at once.
+	///
+	/// @param[in] _handles Body handles.
+	/// @param[in] _num Number of bodies.
+	/// @param[in] _forces Array of `_num` forces.
+	/// @param[in] _activation Activation mode.
+	///
+	void addForces(
+		const BodyHandle* _handles
+		, uint32_t _num
+		, const bx::Vec3* _forces
+		, Activation::Enum _activation
+		);
+
+	/// Retrieve bodies that were active during last physics step, i.e. bodies
+	/// that might have moved.
+	///
+	/// @param[out] _handles Array receiving body handles.
+	/// @param[in] _max Size of `_handles` array.
+	///
+	/// @returns Number of body handles written.
+	///
+	uint32_t getActiveBodies(
+		BodyHandle* _handles
+		, uint32_t _max
+		);
+
+	/// Cast batch of rays, closest hit is returned per ray. Batch is split
+	/// across physics worker threads.
+	///
+	/// @param[in] _rays Array of `_num` rays.
+	/// @param[in] _num Number of rays.
+	/// @param[out] _hits Array of `_num` hits.
+	///
+	void rayCast(
+		const PhysicsRay* _rays
+		, uint32_t _num
+		, PhysicsHit* _hits
+		);
+
+	/// Sweep shape along batch of rays, closest hit is returned per sweep.
+	///
+	/// @param[in] _shape Shape type, `CollisionShape::Sphere`, `CollisionShape::Box`
+	///   or `CollisionShape::Capsule`.
+	/// @param[in] _scale Shape size, same as in `max::createBody`.
+	/// @param[in] _rays Array of `_num` sweeps.
+	/// @param[in] _num Number of sweeps.
+	/// @param[out] _hits Array of `_num` hits.
+	///
+	void shapeCast(
+		CollisionShape::Enum _shape
+		, const bx::Vec3& _scale
+		, const PhysicsRay* _rays
+		, uint32_t _num
+		, PhysicsHit* _hits
+		);
+
+	/// Find bodies overlapping shape placed at batch of positions.
+	///
+	/// @param[in] _shape Shape type, `CollisionShape::Sphere`, `CollisionShape::Box`
+	///   or `CollisionShape::Capsule`.
+	/// @param[in] _scale Shape size, same as in `max::createBody`.
+	/// @param[in] _positions Array of `_num` shape positions.
+	/// @param[in] _num Number of overlap tests.
+	/// @param[out] _bodies Array of `_num * _maxBodies` handles, bodies
+	///   overlapping test `ii` are written starting at `_bodies[ii * _maxBodies]`.
+	/// @param[in] _maxBodies Maximum number of bodies reported per test.
+	/// @param[out] _numBodies Array of `_num` counts of bodies reported per test.
+	///
+	void overlap(
+		CollisionShape::Enum _shape
+		, const bx::Vec3& _scale
+		, const bx::Vec3* _positions
+		, uint32_t _num
+		, BodyHandle* _bodies
+		, uint32_t _maxBodies
+		, uint32_t* _numBodies
+		);
+
 	/// 
 	void setFriction(BodyHandle _handle, float _friction);
 
@@ -4332,6 +5088,10 @@ namespace max
 	/// @param[in] _handle Handle to body object.
 	/// @param[out] _info Ground info.
 	///
+	/// @remarks
+	///   Only bodies created with `MAX_BODY_GROUND_QUERY` flag are evaluated,
+	///   sleeping bodies keep ground info from last step they were active.
+	///
 	void getGroundInfo(
 		BodyHandle _handle
 		, GroundInfo& _info
@@ -4343,6 +5103,72 @@ namespace max
 	///
 	const bx::Vec3 getGravity();
 
+	/// Returns contact events generated by last published physics steps.
+	///
+	/// @param[out] _num Number of events.
+	///
+	/// @returns Array of events, valid until next frame.
+	///
+	const ContactEvent* getContactEvents(uint32_t* _num);
+
+	/// Returns body activation events generated by last published physics
+	/// steps.
+	///
+	/// @param[out] _num Number of events.
+	///
+	/// @returns Array of events, valid until next frame.
+	///
+	const ActivationEvent* getActivationEvents(uint32_t* _num);
+
+	/// Save physics world state, for rollback and replays. Waits for
+	/// pending physics step.
+	///
+	/// @param[out] _data Destination buffer, can be NULL to query size.
+	/// @param[in] _size Size of destination buffer.
+	/// @param[in] _state Snapshot mode. See: `max::PhysicsState`.
+	///
+	/// @returns Size of snapshot. Nothing is written if snapshot doesn't fit
+	///   into `_size` bytes.
+	///
+	/// @remarks
+	///   Only simulation state is saved, bodies must be same on restore.
+	///
+	uint32_t savePhysicsState(
+		  void* _data
+		, uint32_t _size
+		, PhysicsState::Enum _state = PhysicsState::All
+		);
+
+	/// Restore physics world state saved with `max::savePhysicsState`.
+	///
+	/// @param[in] _data Snapshot data.
+	/// @param[in] _size Size of snapshot data.
+	///
+	/// @returns True if state was restored.
+	///
+	bool restorePhysicsState(
+		  const void* _data
+		, uint32_t _size
+		);
+
+	/// Returns interpolation factor between previous and current fixed
+	/// physics step, in range [0, 1).
+	///
+	float getPhysicsAlpha();
+
+	/// Retrieve body transform for rendering, interpolated between previous
+	/// and current fixed physics step. Doesn't block on physics thread.
+	///
+	/// @param[in] _handle Handle to body object.
+	/// @param[out] _pos Interpolated position.
+	/// @param[out] _rot Interpolated rotation.
+	///
+	void getInterpolatedTransform(
+		BodyHandle _handle
+		, bx::Vec3& _pos
+		, bx::Quaternion& _rot
+	);
+
 	/// Create occlusion query.
 	///
 	/// @returns Handle to occlusion query object.
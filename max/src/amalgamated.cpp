@@ -6,9 +6,12 @@
 #include "max.cpp"
 #include "debug_renderdoc.cpp"
 #include "dxgi.cpp"
+#include "ecs.cpp"
+#include "filemap.cpp"
 #include "glcontext_egl.cpp"
 #include "glcontext_wgl.cpp"
 #include "glcontext_html5.cpp"
+#include "jobs.cpp"
 #include "nvapi.cpp"
 #include "renderer_agc.cpp"
 #include "renderer_d3d11.cpp"
@@ -310,6 +310,27 @@
 #	define MAX_CONFIG_MAX_CONTACT_CONSTRAINTS 1024
 #endif // MAX_CONFIG_MAX_CONTACT_CONSTRAINTS
 
+/// Default size of physics temporary allocator used during step.
+#ifndef MAX_CONFIG_PHYSICS_TEMP_ALLOCATOR_SIZE
+#	define MAX_CONFIG_PHYSICS_TEMP_ALLOCATOR_SIZE (10<<20)
+#endif // MAX_CONFIG_PHYSICS_TEMP_ALLOCATOR_SIZE
+
+/// View used for physics debug draw, see `MAX_DEBUG_PHYSICS`.
+#ifndef MAX_CONFIG_DEBUG_PHYSICS_VIEW
+#	define MAX_CONFIG_DEBUG_PHYSICS_VIEW 0
+#endif // MAX_CONFIG_DEBUG_PHYSICS_VIEW
+
+/// Default fixed physics simulation rate in Hz.
+#ifndef MAX_CONFIG_PHYSICS_STEP_RATE
+#	define MAX_CONFIG_PHYSICS_STEP_RATE 60
+#endif // MAX_CONFIG_PHYSICS_STEP_RATE
+
+/// Default maximum number of fixed physics steps per frame, time above it is
+/// dropped so frame spikes don't cause simulation to fall further behind.
+#ifndef MAX_CONFIG_PHYSICS_MAX_SUBSTEPS
+#	define MAX_CONFIG_PHYSICS_MAX_SUBSTEPS 4
+#endif // MAX_CONFIG_PHYSICS_MAX_SUBSTEPS
+
 // Cannot be configured via compiler options.
 #define MAX_CONFIG_MAX_PROGRAMS (1<<MAX_CONFIG_SORT_KEY_NUM_BITS_PROGRAM)
 BX_STATIC_ASSERT(bx::isPowerOf2(MAX_CONFIG_MAX_PROGRAMS), "MAX_CONFIG_MAX_PROGRAMS must be power of 2.");
@@ -389,6 +410,11 @@ BX_STATIC_ASSERT(bx::isPowerOf2(MAX_CONFIG_MAX_VIEWS), "MAX_CONFIG_MAX_VIEWS mus
 #	define MAX_CONFIG_MAX_MESH_GROUPS 124
 #endif // MAX_CONFIG_MAX_MESH_GROUPS
 
+/// Maximum number of simplified LODs per mesh group.
+#ifndef MAX_CONFIG_MAX_MESH_LODS
+#	define MAX_CONFIG_MAX_MESH_LODS 8
+#endif // MAX_CONFIG_MAX_MESH_LODS
+
 #ifndef MAX_CONFIG_MAX_DYNAMIC_MESHES
 #	define MAX_CONFIG_MAX_DYNAMIC_MESHES 1024
 #endif // MAX_CONFIG_MAX_DYNAMIC_MESHES
@@ -397,9 +423,25 @@ BX_STATIC_ASSERT(bx::isPowerOf2(MAX_CONFIG_MAX_VIEWS), "MAX_CONFIG_MAX_VIEWS mus
 #	define MAX_CONFIG_MAX_DYNAMIC_MESH_GROUPS 124
 #endif // MAX_CONFIG_MAX_DYNAMIC_MESH_GROUPS
 
-#ifndef MAX_CONFIG_MAX_COMPONENTS
-#	define MAX_CONFIG_MAX_COMPONENTS 512
-#endif // MAX_CONFIG_MAX_COMPONENTS
+/// Maximum number of asynchronous loads in flight.
+#ifndef MAX_CONFIG_MAX_ASYNC_LOADS
+#	define MAX_CONFIG_MAX_ASYNC_LOADS 256
+#endif // MAX_CONFIG_MAX_ASYNC_LOADS
+
+/// Number of threads reading and decoding asynchronously loaded assets.
+#ifndef MAX_CONFIG_NUM_IO_THREADS
+#	define MAX_CONFIG_NUM_IO_THREADS 2
+#endif // MAX_CONFIG_NUM_IO_THREADS
+
+/// Default number of bytes of asynchronously loaded assets uploaded per frame.
+#ifndef MAX_CONFIG_ASYNC_UPLOAD_BUDGET
+#	define MAX_CONFIG_ASYNC_UPLOAD_BUDGET (4<<20)
+#endif // MAX_CONFIG_ASYNC_UPLOAD_BUDGET
+
+/// Initial component pool size, pool grows on demand.
+#ifndef MAX_CONFIG_DEFAULT_COMPONENT_POOL_SIZE
+#	define MAX_CONFIG_DEFAULT_COMPONENT_POOL_SIZE (8<<10)
+#endif // MAX_CONFIG_DEFAULT_COMPONENT_POOL_SIZE
 
 #ifndef MAX_CONFIG_MAX_COMPONENTS_TYPES
 #	define MAX_CONFIG_MAX_COMPONENTS_TYPES 64
@@ -413,9 +455,59 @@ BX_STATIC_ASSERT(bx::isPowerOf2(MAX_CONFIG_MAX_VIEWS), "MAX_CONFIG_MAX_VIEWS mus
 #	define MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY 64
 #endif // MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY
 
-#ifndef MAX_CONFIG_MAX_ENTITIES
-#	define MAX_CONFIG_MAX_ENTITIES 256
-#endif // MAX_CONFIG_MAX_ENTITIES
+/// Initial entity pool size, pool grows on demand.
+#ifndef MAX_CONFIG_DEFAULT_ENTITY_POOL_SIZE
+#	define MAX_CONFIG_DEFAULT_ENTITY_POOL_SIZE (4<<10)
+#endif // MAX_CONFIG_DEFAULT_ENTITY_POOL_SIZE
+
+/// Number of entity and component references per pool page.
+#ifndef MAX_CONFIG_ECS_PAGE_SIZE
+#	define MAX_CONFIG_ECS_PAGE_SIZE (4<<10)
+#endif // MAX_CONFIG_ECS_PAGE_SIZE
+
+/// Initial size of frame arena used for query results, arena grows on demand.
+#ifndef MAX_CONFIG_ECS_QUERY_ARENA_SIZE
+#	define MAX_CONFIG_ECS_QUERY_ARENA_SIZE (256<<10)
+#endif // MAX_CONFIG_ECS_QUERY_ARENA_SIZE
+
+/// Maximum number of archetypes. Archetypes are allocated on demand, limit
+/// only sizes archetype lookup.
+#ifndef MAX_CONFIG_MAX_ARCHETYPES
+#	define MAX_CONFIG_MAX_ARCHETYPES 256
+#endif // MAX_CONFIG_MAX_ARCHETYPES
+
+/// Number of archetypes and cached entity queries per pool page.
+#ifndef MAX_CONFIG_ECS_ARCHETYPE_PAGE_SIZE
+#	define MAX_CONFIG_ECS_ARCHETYPE_PAGE_SIZE 16
+#endif // MAX_CONFIG_ECS_ARCHETYPE_PAGE_SIZE
+
+/// Maximum number of cached entity queries, one per unique set of queried
+/// component types. Queries are allocated on demand, limit only sizes query
+/// lookup.
+#ifndef MAX_CONFIG_MAX_ENTITY_QUERIES
+#	define MAX_CONFIG_MAX_ENTITY_QUERIES 256
+#endif // MAX_CONFIG_MAX_ENTITY_QUERIES
+
+/// Maximum number of entity command buffers recorded between two frames.
+#ifndef MAX_CONFIG_MAX_ENTITY_COMMAND_BUFFERS
+#	define MAX_CONFIG_MAX_ENTITY_COMMAND_BUFFERS 64
+#endif // MAX_CONFIG_MAX_ENTITY_COMMAND_BUFFERS
+
+/// Size of single archetype chunk in bytes. Entities sharing the same set
+/// of components are packed into chunks, with one array per component type.
+#ifndef MAX_CONFIG_ECS_CHUNK_SIZE
+#	define MAX_CONFIG_ECS_CHUNK_SIZE (16<<10)
+#endif // MAX_CONFIG_ECS_CHUNK_SIZE
+
+/// Maximum number of worker threads used for parallel jobs.
+#ifndef MAX_CONFIG_MAX_JOB_THREADS
+#	define MAX_CONFIG_MAX_JOB_THREADS 8
+#endif // MAX_CONFIG_MAX_JOB_THREADS
+
+/// Size of job queue.
+#ifndef MAX_CONFIG_MAX_JOBS
+#	define MAX_CONFIG_MAX_JOBS 1024
+#endif // MAX_CONFIG_MAX_JOBS
 
 #ifndef MAX_CONFIG_MAX_OCCLUSION_QUERIES
 #	define MAX_CONFIG_MAX_OCCLUSION_QUERIES 256
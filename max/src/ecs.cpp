@@ -0,0 +1,486 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#include <bx/allocator.h>
+#include <bx/debug.h>
+#include <bx/handlealloc.h>
+#include <bx/hash.h>
+#include <bx/math.h>
+#include <bx/mutex.h>
+#include <bx/sort.h>
+
+#include "config.h"
+#include "ecs.h"
+
+namespace max
+{
+	static const uint32_t kChunkAlign = 64;
+
+	static uint32_t alignUp(uint32_t _offset)
+	{
+		return (_offset + kChunkAlign - 1) & ~(kChunkAlign - 1);
+	}
+
+	struct ComponentTypeRegistry
+	{
+		ComponentTypeRegistry()
+			: m_num(0)
+		{
+		}
+
+		bx::Mutex m_lock;
+		bx::HandleHashMapT<MAX_CONFIG_MAX_COMPONENTS_TYPES*2> m_hashMap;
+		uint32_t m_hash[MAX_CONFIG_MAX_COMPONENTS_TYPES];
+		uint32_t m_size[MAX_CONFIG_MAX_COMPONENTS_TYPES];
+		uint16_t m_num;
+	};
+
+	static ComponentTypeRegistry& getComponentTypeRegistry()
+	{
+		static ComponentTypeRegistry s_registry;
+		return s_registry;
+	}
+
+	ComponentTypeHandle componentTypeRegister(uint32_t _hash, uint32_t _size)
+	{
+		ComponentTypeRegistry& registry = getComponentTypeRegistry();
+		bx::MutexScope lock(registry.m_lock);
+
+		ComponentTypeHandle handle = { registry.m_hashMap.find(_hash) };
+		if (isValid(handle) )
+		{
+			uint32_t& size = registry.m_size[handle.idx];
+			BX_ASSERT(0 == size || 0 == _size || size == _size, "Component type size mismatch %d (registered: %d).", _size, size);
+			size = 0 == size ? _size : size;
+			return handle;
+		}
+
+		if (registry.m_num >= MAX_CONFIG_MAX_COMPONENTS_TYPES)
+		{
+			BX_WARN(false, "Too many component types (max: %d).", MAX_CONFIG_MAX_COMPONENTS_TYPES);
+			return handle;
+		}
+
+		handle.idx = registry.m_num++;
+		registry.m_hashMap.insert(_hash, handle.idx);
+		registry.m_hash[handle.idx] = _hash;
+		registry.m_size[handle.idx] = _size;
+
+		return handle;
+	}
+
+	ComponentTypeHandle componentTypeFind(uint32_t _hash)
+	{
+		ComponentTypeRegistry& registry = getComponentTypeRegistry();
+		bx::MutexScope lock(registry.m_lock);
+
+		ComponentTypeHandle handle = { registry.m_hashMap.find(_hash) };
+		return handle;
+	}
+
+	uint32_t componentTypeGetSize(ComponentTypeHandle _type)
+	{
+		ComponentTypeRegistry& registry = getComponentTypeRegistry();
+		bx::MutexScope lock(registry.m_lock);
+
+		return isValid(_type) ? registry.m_size[_type.idx] : 0;
+	}
+
+	uint32_t ComponentMask::getKey() const
+	{
+		bx::HashMurmur2A murmur;
+		murmur.begin();
+		murmur.add(m_bits, sizeof(m_bits) );
+		return murmur.end();
+	}
+
+	static int32_t compareColumn(const void* _lhs, const void* _rhs)
+	{
+		const ArchetypeColumn& lhs = *(const ArchetypeColumn*)_lhs;
+		const ArchetypeColumn& rhs = *(const ArchetypeColumn*)_rhs;
+		return int32_t(lhs.m_type.idx) - int32_t(rhs.m_type.idx);
+	}
+
+	void archetypeSortColumns(ArchetypeColumn* _columns, uint32_t _num)
+	{
+		bx::quickSort(_columns, _num, sizeof(ArchetypeColumn), compareColumn);
+	}
+
+	Archetype::Archetype()
+		: m_allocator(NULL)
+		, m_chunks(NULL)
+		, m_numChunks(0)
+		, m_maxChunks(0)
+		, m_chunkSize(0)
+		, m_chunkVersionOffset(0)
+		, m_capacity(0)
+		, m_num(0)
+		, m_numColumns(0)
+	{
+		m_mask.reset();
+		bx::memSet(m_columnIndex, UINT8_MAX, sizeof(m_columnIndex) );
+	}
+
+	void Archetype::create(const ArchetypeColumn* _columns, uint32_t _num, bx::AllocatorI* _allocator)
+	{
+		BX_ASSERT(_num <= MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY, "Too many components per entity %d (max: %d)."
+			, _num
+			, MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY
+			);
+
+		m_allocator = _allocator;
+		m_numColumns = _num;
+		m_num = 0;
+		m_numChunks = 0;
+		m_maxChunks = 0;
+		m_chunks = NULL;
+
+		m_mask.reset();
+		bx::memSet(m_columnIndex, UINT8_MAX, sizeof(m_columnIndex) );
+
+		uint32_t stride = sizeof(EntityHandle);
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			m_columns[ii] = _columns[ii];
+			m_columnIndex[_columns[ii].m_type.idx] = uint8_t(ii);
+			m_mask.set(_columns[ii].m_type);
+			stride += sizeof(ComponentHandle) + sizeof(uint32_t) + _columns[ii].m_size;
+		}
+
+		// Every array inside chunk is aligned, reserve space for padding and
+		// chunk versions.
+		const uint32_t padding = (2 + 3*_num) * kChunkAlign + _num*sizeof(uint32_t);
+		m_capacity = MAX_CONFIG_ECS_CHUNK_SIZE > padding + stride
+			? (MAX_CONFIG_ECS_CHUNK_SIZE - padding) / stride
+			: 1
+			;
+
+		uint32_t offset = alignUp(m_capacity * sizeof(EntityHandle) );
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			ArchetypeColumn& column = m_columns[ii];
+			column.m_handleOffset = offset;
+			offset = alignUp(offset + m_capacity * sizeof(ComponentHandle) );
+			column.m_offset = offset;
+			offset = alignUp(offset + m_capacity * column.m_size);
+			column.m_versionOffset = offset;
+			offset = alignUp(offset + m_capacity * sizeof(uint32_t) );
+		}
+
+		m_chunkVersionOffset = offset;
+		m_chunkSize = offset + bx::max<uint32_t>(_num, 1)*sizeof(uint32_t);
+	}
+
+	void Archetype::destroy()
+	{
+		for (uint32_t ii = 0; ii < m_numChunks; ++ii)
+		{
+			bx::alignedFree(m_allocator, m_chunks[ii], kChunkAlign);
+		}
+
+		bx::free(m_allocator, m_chunks);
+
+		m_chunks = NULL;
+		m_numChunks = 0;
+		m_maxChunks = 0;
+		m_num = 0;
+		m_numColumns = 0;
+	}
+
+	uint32_t Archetype::alloc(EntityHandle _first, uint32_t _num)
+	{
+		const uint32_t numChunks = (m_num + _num + m_capacity - 1) / m_capacity;
+		if (numChunks > m_maxChunks)
+		{
+			m_maxChunks = bx::max<uint32_t>(8, bx::max<uint32_t>(numChunks, m_maxChunks*2) );
+			m_chunks = (uint8_t**)bx::realloc(m_allocator, m_chunks, m_maxChunks*sizeof(uint8_t*) );
+		}
+
+		for (; m_numChunks < numChunks; ++m_numChunks)
+		{
+			uint8_t* chunk = (uint8_t*)bx::alignedAlloc(m_allocator, m_chunkSize, kChunkAlign);
+			bx::memSet(&chunk[m_chunkVersionOffset], 0, m_numColumns*sizeof(uint32_t) );
+
+			m_chunks[m_numChunks] = chunk;
+		}
+
+		const uint32_t first = m_num;
+		m_num += _num;
+
+		for (uint32_t row = first, end = m_num; row < end;)
+		{
+			const uint32_t chunk = row / m_capacity;
+			const uint32_t begin = row % m_capacity;
+			const uint32_t num   = bx::min(m_capacity - begin, end - row);
+
+			EntityHandle* entities = getEntities(chunk);
+			for (uint32_t ii = 0; ii < num; ++ii)
+			{
+				entities[begin + ii].idx = _first.idx + row - first + ii;
+			}
+
+			for (uint32_t ii = 0; ii < m_numColumns; ++ii)
+			{
+				bx::memSet(&getVersions(chunk, ii)[begin], 0, num*sizeof(uint32_t) );
+			}
+
+			row += num;
+		}
+
+		return first;
+	}
+
+	EntityHandle Archetype::free(uint32_t _row)
+	{
+		BX_ASSERT(_row < m_num, "Invalid archetype row %d (num: %d).", _row, m_num);
+
+		EntityHandle moved = MAX_INVALID_HANDLE32;
+
+		const uint32_t last = --m_num;
+		if (_row != last)
+		{
+			moved = getEntity(last);
+			getEntities(_row / m_capacity)[_row % m_capacity] = moved;
+
+			for (uint32_t ii = 0; ii < m_numColumns; ++ii)
+			{
+				getHandle(_row, ii) = getHandle(last, ii);
+				bx::memCopy(getComponent(_row, ii), getComponent(last, ii), m_columns[ii].m_size);
+				setVersion(_row, ii, getVersion(last, ii) );
+			}
+		}
+
+		if (0 == m_num % m_capacity)
+		{
+			--m_numChunks;
+			bx::alignedFree(m_allocator, m_chunks[m_numChunks], kChunkAlign);
+		}
+
+		return moved;
+	}
+
+	HandleAlloc32::HandleAlloc32()
+		: m_allocator(NULL)
+		, m_dense(NULL)
+		, m_sparse(NULL)
+		, m_numHandles(0)
+		, m_numPending(0)
+		, m_maxHandles(0)
+	{
+	}
+
+	void HandleAlloc32::init(uint32_t _maxHandles, bx::AllocatorI* _allocator)
+	{
+		m_allocator = _allocator;
+		m_numHandles = 0;
+		m_numPending = 0;
+		m_maxHandles = 0;
+		grow(bx::max<uint32_t>(_maxHandles, 1) );
+	}
+
+	void HandleAlloc32::shutdown()
+	{
+		bx::free(m_allocator, m_dense);
+		bx::free(m_allocator, m_sparse);
+
+		m_dense = NULL;
+		m_sparse = NULL;
+		m_numHandles = 0;
+		m_numPending = 0;
+		m_maxHandles = 0;
+	}
+
+	void HandleAlloc32::grow(uint32_t _maxHandles)
+	{
+		BX_ASSERT(_maxHandles < kInvalidHandle32, "Too many handles %d.", _maxHandles);
+
+		m_dense  = (uint32_t*)bx::realloc(m_allocator, m_dense,  _maxHandles*sizeof(uint32_t) );
+		m_sparse = (uint32_t*)bx::realloc(m_allocator, m_sparse, _maxHandles*sizeof(uint32_t) );
+
+		for (uint32_t ii = m_maxHandles; ii < _maxHandles; ++ii)
+		{
+			m_dense[ii]  = ii;
+			m_sparse[ii] = ii;
+		}
+
+		m_maxHandles = _maxHandles;
+	}
+
+	void HandleAlloc32::swap(uint32_t _indexA, uint32_t _indexB)
+	{
+		const uint32_t handleA = m_dense[_indexA];
+		const uint32_t handleB = m_dense[_indexB];
+		m_dense[_indexA] = handleB;
+		m_dense[_indexB] = handleA;
+		m_sparse[handleB] = _indexA;
+		m_sparse[handleA] = _indexB;
+	}
+
+	uint32_t HandleAlloc32::take(uint32_t _index)
+	{
+		BX_ASSERT(_index >= m_numHandles + m_numPending, "Handle at %d is not free.", _index);
+
+		// Move handle to first free slot, then swap it with first pending
+		// handle, pending range shifts by one.
+		swap(_index, m_numHandles + m_numPending);
+		swap(m_numHandles + m_numPending, m_numHandles);
+
+		return m_dense[m_numHandles++];
+	}
+
+	uint32_t HandleAlloc32::alloc()
+	{
+		if (m_numHandles + m_numPending == m_maxHandles)
+		{
+			grow(m_maxHandles*2);
+		}
+
+		return take(m_numHandles + m_numPending);
+	}
+
+	uint32_t HandleAlloc32::allocRange(uint32_t _num)
+	{
+		if (0 == _num)
+		{
+			return kInvalidHandle32;
+		}
+
+		// Unused handles at the end of storage are only contiguous if no
+		// handle was freed into that range, otherwise grow past it.
+		uint32_t first = m_maxHandles;
+		uint32_t num   = 0;
+		for (uint32_t ii = m_maxHandles; ii > 0 && num < _num; --ii)
+		{
+			const uint32_t handle = ii - 1;
+			if (m_sparse[handle] < m_numHandles + m_numPending)
+			{
+				break;
+			}
+
+			first = handle;
+			++num;
+		}
+
+		const uint32_t maxHandles = first + _num;
+		if (maxHandles > m_maxHandles)
+		{
+			grow(bx::max<uint32_t>(maxHandles, m_maxHandles*2) );
+		}
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			take(m_sparse[first + ii]);
+		}
+
+		return first;
+	}
+
+	void HandleAlloc32::free(uint32_t _handle)
+	{
+		BX_ASSERT(isValid(_handle), "Freeing invalid handle %d.", _handle);
+
+		// Last allocated slot becomes first pending slot.
+		--m_numHandles;
+		swap(m_sparse[_handle], m_numHandles);
+		++m_numPending;
+	}
+
+	FrameArena::FrameArena()
+		: m_allocator(NULL)
+		, m_data(NULL)
+		, m_overflow(NULL)
+		, m_size(0)
+		, m_pos(0)
+		, m_used(0)
+		, m_numOverflows(0)
+	{
+	}
+
+	void FrameArena::init(uint32_t _size, bx::AllocatorI* _allocator)
+	{
+		m_allocator = _allocator;
+		m_size = alignUp(bx::max<uint32_t>(_size, kChunkAlign) );
+		m_data = (uint8_t*)bx::alignedAlloc(m_allocator, m_size, kChunkAlign);
+		m_pos = 0;
+	}
+
+	void FrameArena::shutdown()
+	{
+		reset();
+
+		bx::alignedFree(m_allocator, m_data, kChunkAlign);
+
+		m_data = NULL;
+		m_size = 0;
+	}
+
+	void* FrameArena::alloc(uint32_t _size, uint32_t _align)
+	{
+		BX_ASSERT(bx::isPowerOf2(_align) && _align <= kChunkAlign, "Invalid alignment %d.", _align);
+
+		const uint32_t pos = (m_pos + _align - 1) & ~(_align - 1);
+		if (pos + _size <= m_size)
+		{
+			m_used += pos + _size - m_pos;
+			m_pos = pos + _size;
+			return &m_data[pos];
+		}
+
+		// Out of space, keep current block intact since previous allocations
+		// are still in use, and bump allocate from overflow block instead.
+		Block* block = m_overflow;
+		uint32_t blockPos = NULL != block ? (block->m_pos + _align - 1) & ~(_align - 1) : 0;
+
+		if (NULL == block
+		||  blockPos + _size > block->m_size)
+		{
+			const uint32_t size = alignUp(bx::max<uint32_t>(
+				  NULL != block ? block->m_size*2 : m_size
+				, kChunkAlign + _size
+				) );
+
+			block = (Block*)bx::alignedAlloc(m_allocator, size, kChunkAlign);
+			block->m_next = m_overflow;
+			block->m_size = size;
+			block->m_pos  = kChunkAlign;
+			m_overflow = block;
+			++m_numOverflows;
+
+			blockPos = kChunkAlign;
+		}
+
+		m_used += blockPos + _size - block->m_pos;
+		block->m_pos = blockPos + _size;
+
+		return (uint8_t*)block + blockPos;
+	}
+
+	void FrameArena::reset()
+	{
+		if (NULL != m_overflow)
+		{
+			while (NULL != m_overflow)
+			{
+				Block* next = m_overflow->m_next;
+				bx::alignedFree(m_allocator, m_overflow, kChunkAlign);
+				m_overflow = next;
+			}
+
+			// Grow main block to high-water mark, so next frame with same
+			// usage doesn't overflow.
+			if (NULL != m_data)
+			{
+				bx::alignedFree(m_allocator, m_data, kChunkAlign);
+				m_size = alignUp(bx::max<uint32_t>(m_size, m_used) );
+				m_data = (uint8_t*)bx::alignedAlloc(m_allocator, m_size, kChunkAlign);
+			}
+		}
+
+		m_pos  = 0;
+		m_used = 0;
+		m_numOverflows = 0;
+	}
+
+} // namespace max
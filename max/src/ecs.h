@@ -0,0 +1,530 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#ifndef MAX_ECS_H_HEADER_GUARD
+#define MAX_ECS_H_HEADER_GUARD
+
+#include <max/max.h>
+#include <bx/allocator.h>
+#include <bx/cpu.h>
+
+#include "config.h"
+
+namespace max
+{
+	/// Set of component types, one bit per type id.
+	///
+	struct ComponentMask
+	{
+		enum { NumWords = (MAX_CONFIG_MAX_COMPONENTS_TYPES + 63) / 64 };
+
+		void reset()
+		{
+			bx::memSet(m_bits, 0, sizeof(m_bits) );
+		}
+
+		void set(ComponentTypeHandle _type)
+		{
+			m_bits[_type.idx / 64] |= UINT64_C(1) << (_type.idx % 64);
+		}
+
+		void unset(ComponentTypeHandle _type)
+		{
+			m_bits[_type.idx / 64] &= ~(UINT64_C(1) << (_type.idx % 64) );
+		}
+
+		bool has(ComponentTypeHandle _type) const
+		{
+			return 0 != (m_bits[_type.idx / 64] & (UINT64_C(1) << (_type.idx % 64) ) );
+		}
+
+		/// Returns true if all component types of `_other` are in this set.
+		bool contains(const ComponentMask& _other) const
+		{
+			for (uint32_t ii = 0; ii < NumWords; ++ii)
+			{
+				if (_other.m_bits[ii] != (m_bits[ii] & _other.m_bits[ii]) )
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool operator==(const ComponentMask& _other) const
+		{
+			return 0 == bx::memCmp(m_bits, _other.m_bits, sizeof(m_bits) );
+		}
+
+		/// Returns hash of component set.
+		uint32_t getKey() const;
+
+		uint64_t m_bits[NumWords];
+	};
+
+	/// Register component type and return its dense id. Registering the same
+	/// hash multiple times returns the same id. Registry is global and
+	/// outlives context, so ids cached by templates stay valid.
+	ComponentTypeHandle componentTypeRegister(uint32_t _hash, uint32_t _size);
+
+	/// Returns id of previously registered component type, or invalid handle.
+	ComponentTypeHandle componentTypeFind(uint32_t _hash);
+
+	/// Returns size of component type, zero if unknown.
+	uint32_t componentTypeGetSize(ComponentTypeHandle _type);
+
+	/// Component column of archetype.
+	///
+	struct ArchetypeColumn
+	{
+		ComponentTypeHandle m_type; //!< Component type.
+		uint32_t m_size;         //!< Size of single component.
+		uint32_t m_offset;       //!< Offset of component array inside chunk.
+		uint32_t m_handleOffset; //!< Offset of component handle array inside chunk.
+		uint32_t m_versionOffset; //!< Offset of change version array inside chunk.
+	};
+
+	/// Archetype, storage for all entities sharing same set of components.
+	///
+	/// Entities are packed into fixed size chunks, each chunk holds entity
+	/// handle array followed by one handle, one data and one change version
+	/// array per component type (SoA), and per column chunk version which is
+	/// maximum of all row versions in chunk. Rows are kept dense, only last
+	/// chunk can be partially filled.
+	///
+	struct Archetype
+	{
+		Archetype();
+
+		/// Create archetype from component columns sorted by type.
+		void create(const ArchetypeColumn* _columns, uint32_t _num, bx::AllocatorI* _allocator);
+
+		///
+		void destroy();
+
+		/// Returns column index of component type, or `UINT32_MAX` if
+		/// archetype doesn't contain component type.
+		uint32_t findColumn(ComponentTypeHandle _type) const
+		{
+			const uint8_t column = m_columnIndex[_type.idx];
+			return UINT8_MAX == column ? UINT32_MAX : column;
+		}
+
+		/// Allocate row for entity, returns row index.
+		uint32_t alloc(EntityHandle _entity)
+		{
+			return alloc(_entity, 1);
+		}
+
+		/// Allocate `_num` consecutive rows for entities with consecutive
+		/// handles starting at `_first`, returns index of first row.
+		uint32_t alloc(EntityHandle _first, uint32_t _num);
+
+		/// Free row by moving last row into it. Returns entity that was moved
+		/// into `_row`, or invalid handle if no entity was moved.
+		EntityHandle free(uint32_t _row);
+
+		///
+		uint32_t getNumChunks() const
+		{
+			return m_numChunks;
+		}
+
+		/// Returns number of rows used in chunk.
+		uint32_t getNumRows(uint32_t _chunk) const
+		{
+			const uint32_t first = _chunk*m_capacity;
+			return bx::min(m_num - first, m_capacity);
+		}
+
+		///
+		EntityHandle* getEntities(uint32_t _chunk) const
+		{
+			return (EntityHandle*)m_chunks[_chunk];
+		}
+
+		///
+		ComponentHandle* getHandles(uint32_t _chunk, uint32_t _column) const
+		{
+			return (ComponentHandle*)&m_chunks[_chunk][m_columns[_column].m_handleOffset];
+		}
+
+		///
+		uint8_t* getData(uint32_t _chunk, uint32_t _column) const
+		{
+			return &m_chunks[_chunk][m_columns[_column].m_offset];
+		}
+
+		///
+		uint32_t* getVersions(uint32_t _chunk, uint32_t _column) const
+		{
+			return (uint32_t*)&m_chunks[_chunk][m_columns[_column].m_versionOffset];
+		}
+
+		/// Returns highest change version of column in chunk.
+		uint32_t getChunkVersion(uint32_t _chunk, uint32_t _column) const
+		{
+			return ( (const uint32_t*)&m_chunks[_chunk][m_chunkVersionOffset])[_column];
+		}
+
+		///
+		uint32_t getVersion(uint32_t _row, uint32_t _column) const
+		{
+			return getVersions(_row / m_capacity, _column)[_row % m_capacity];
+		}
+
+		/// Set change version of component at row, and bump chunk version.
+		/// Rows of same chunk can be written from multiple jobs, chunk
+		/// version is bumped with atomic max.
+		void setVersion(uint32_t _row, uint32_t _column, uint32_t _version)
+		{
+			const uint32_t chunk = _row / m_capacity;
+			getVersions(chunk, _column)[_row % m_capacity] = _version;
+
+			uint32_t* chunkVersion = &( (uint32_t*)&m_chunks[chunk][m_chunkVersionOffset])[_column];
+
+			uint32_t current = bx::atomicFetchAndAdd<uint32_t>(chunkVersion, 0);
+			while (current < _version)
+			{
+				const uint32_t prev = bx::atomicCompareAndSwap<uint32_t>(chunkVersion, current, _version);
+				if (prev == current)
+				{
+					break;
+				}
+
+				current = prev;
+			}
+		}
+
+		///
+		EntityHandle getEntity(uint32_t _row) const
+		{
+			return getEntities(_row / m_capacity)[_row % m_capacity];
+		}
+
+		///
+		ComponentHandle& getHandle(uint32_t _row, uint32_t _column) const
+		{
+			return getHandles(_row / m_capacity, _column)[_row % m_capacity];
+		}
+
+		///
+		void* getComponent(uint32_t _row, uint32_t _column) const
+		{
+			return getData(_row / m_capacity, _column) + (_row % m_capacity) * m_columns[_column].m_size;
+		}
+
+		bx::AllocatorI* m_allocator;
+		uint8_t** m_chunks;
+		uint32_t m_numChunks;
+		uint32_t m_maxChunks;
+		uint32_t m_chunkSize;
+		uint32_t m_chunkVersionOffset;
+		uint32_t m_capacity; //!< Number of rows per chunk.
+		uint32_t m_num;      //!< Number of rows.
+		uint32_t m_numColumns;
+		ComponentMask m_mask;
+		ArchetypeColumn m_columns[MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY];
+		uint8_t m_columnIndex[MAX_CONFIG_MAX_COMPONENTS_TYPES];
+	};
+
+	/// Cached query, list of archetypes containing all requested component
+	/// types. Kept up to date as archetypes are created.
+	///
+	struct ArchetypeQuery
+	{
+		///
+		ArchetypeQuery()
+			: m_allocator(NULL)
+			, m_archetypes(NULL)
+			, m_numArchetypes(0)
+			, m_maxArchetypes(0)
+		{
+			m_mask.reset();
+		}
+
+		/// Reset query to `_mask`, archetype list storage is kept.
+		void create(const ComponentMask& _mask, bx::AllocatorI* _allocator)
+		{
+			m_allocator = _allocator;
+			m_mask = _mask;
+			m_numArchetypes = 0;
+		}
+
+		///
+		void destroy()
+		{
+			bx::free(m_allocator, m_archetypes);
+
+			m_archetypes = NULL;
+			m_numArchetypes = 0;
+			m_maxArchetypes = 0;
+		}
+
+		/// Returns true if archetype contains all component types of query.
+		bool matches(const Archetype& _archetype) const
+		{
+			return _archetype.m_mask.contains(m_mask);
+		}
+
+		///
+		void add(uint16_t _archetype)
+		{
+			if (m_numArchetypes == m_maxArchetypes)
+			{
+				m_maxArchetypes = bx::max<uint16_t>(16, m_maxArchetypes*2);
+				m_archetypes = (uint16_t*)bx::realloc(m_allocator, m_archetypes, m_maxArchetypes*sizeof(uint16_t) );
+			}
+
+			m_archetypes[m_numArchetypes++] = _archetype;
+		}
+
+		bx::AllocatorI* m_allocator;
+		ComponentMask m_mask;
+		uint16_t* m_archetypes;
+		uint16_t m_numArchetypes;
+		uint16_t m_maxArchetypes;
+	};
+
+	/// Sort component columns by type.
+	void archetypeSortColumns(ArchetypeColumn* _columns, uint32_t _num);
+
+	/// Growable handle allocator with 32-bit handles. Freed handles are not
+	/// reused until `releasePending` is called, stale handle kept by user
+	/// stays invalid for at least one frame.
+	///
+	class HandleAlloc32
+	{
+	public:
+		///
+		HandleAlloc32();
+
+		///
+		void init(uint32_t _maxHandles, bx::AllocatorI* _allocator);
+
+		///
+		void shutdown();
+
+		/// Allocate handle, grows if all handles are in use.
+		uint32_t alloc();
+
+		/// Allocate `_num` consecutive handles from unused range at the end.
+		/// Returns first handle or `kInvalidHandle32`.
+		uint32_t allocRange(uint32_t _num);
+
+		///
+		void free(uint32_t _handle);
+
+		/// Make handles freed since last call available for allocation.
+		void releasePending()
+		{
+			m_numPending = 0;
+		}
+
+		///
+		bool isValid(uint32_t _handle) const
+		{
+			return _handle < m_maxHandles
+				&& m_sparse[_handle] < m_numHandles
+				&& m_dense[m_sparse[_handle] ] == _handle
+				;
+		}
+
+		///
+		uint32_t getNumHandles() const
+		{
+			return m_numHandles;
+		}
+
+		///
+		uint32_t getMaxHandles() const
+		{
+			return m_maxHandles;
+		}
+
+		///
+		uint32_t getHandleAt(uint32_t _at) const
+		{
+			return m_dense[_at];
+		}
+
+	private:
+		void grow(uint32_t _maxHandles);
+		void swap(uint32_t _indexA, uint32_t _indexB);
+		uint32_t take(uint32_t _index);
+
+		bx::AllocatorI* m_allocator;
+		uint32_t* m_dense;   //!< Allocated handles, followed by pending and free handles.
+		uint32_t* m_sparse;
+		uint32_t m_numHandles;
+		uint32_t m_numPending; //!< Freed handles not yet available for allocation.
+		uint32_t m_maxHandles;
+	};
+
+	/// Growable array with stable element addresses. Elements are not
+	/// constructed, `Ty` must be trivially copyable. Page table is never
+	/// reallocated in place, on growth it's copied and old table is kept
+	/// until shutdown, so readers of existing elements never see freed
+	/// memory while other thread grows array.
+	///
+	template<typename Ty, uint32_t PageSizeT = MAX_CONFIG_ECS_PAGE_SIZE>
+	class PagedArray
+	{
+	public:
+		///
+		PagedArray()
+			: m_allocator(NULL)
+			, m_pages(NULL)
+			, m_numPages(0)
+			, m_maxPages(0)
+		{
+		}
+
+		///
+		void init(uint32_t _num, bx::AllocatorI* _allocator)
+		{
+			m_allocator = _allocator;
+			reserve(_num);
+		}
+
+		///
+		void shutdown()
+		{
+			for (uint32_t ii = 0; ii < m_numPages; ++ii)
+			{
+				bx::free(m_allocator, m_pages[ii]);
+			}
+
+			// First slot of each table points to previous table.
+			Ty** pages = m_pages;
+			while (NULL != pages)
+			{
+				Ty** prev = (Ty**)pages[-1];
+				bx::free(m_allocator, &pages[-1]);
+				pages = prev;
+			}
+
+			m_pages = NULL;
+			m_numPages = 0;
+			m_maxPages = 0;
+		}
+
+		/// Make sure there is storage for at least `_num` elements.
+		void reserve(uint32_t _num)
+		{
+			const uint32_t numPages = (_num + PageSizeT - 1) / PageSizeT;
+			if (numPages <= m_numPages)
+			{
+				return;
+			}
+
+			Ty** pages = m_pages;
+			if (numPages > m_maxPages)
+			{
+				m_maxPages = bx::max<uint32_t>(numPages, m_maxPages*2);
+
+				pages = (Ty**)bx::alloc(m_allocator, (m_maxPages + 1)*sizeof(Ty*) ) + 1;
+				pages[-1] = (Ty*)m_pages;
+				bx::memCopy(pages, m_pages, m_numPages*sizeof(Ty*) );
+			}
+
+			for (uint32_t ii = m_numPages; ii < numPages; ++ii)
+			{
+				pages[ii] = (Ty*)bx::alloc(m_allocator, PageSizeT*sizeof(Ty) );
+			}
+
+			// Publish table only after it's filled.
+			m_pages = pages;
+			m_numPages = numPages;
+		}
+
+		///
+		uint32_t getCapacity() const
+		{
+			return m_numPages*PageSizeT;
+		}
+
+		///
+		Ty& operator[](uint32_t _idx)
+		{
+			return m_pages[_idx / PageSizeT][_idx % PageSizeT];
+		}
+
+		///
+		const Ty& operator[](uint32_t _idx) const
+		{
+			return m_pages[_idx / PageSizeT][_idx % PageSizeT];
+		}
+
+	private:
+		bx::AllocatorI* m_allocator;
+		Ty** m_pages;
+		uint32_t m_numPages;
+		uint32_t m_maxPages;
+	};
+
+	/// Linear allocator for data that lives until end of frame. All memory
+	/// is released at once on reset. When arena runs out, overflow blocks of
+	/// at least arena size (doubling) are allocated and bump allocated from.
+	/// On reset main block grows to last frame's high-water mark, so steady
+	/// state doesn't touch heap.
+	///
+	class FrameArena
+	{
+	public:
+		///
+		FrameArena();
+
+		///
+		void init(uint32_t _size, bx::AllocatorI* _allocator);
+
+		///
+		void shutdown();
+
+		/// Allocate memory valid until next reset. Not thread safe.
+		void* alloc(uint32_t _size, uint32_t _align = 16);
+
+		///
+		void reset();
+
+		/// Size of main block.
+		uint32_t getSize() const
+		{
+			return m_size;
+		}
+
+		/// Bytes allocated since last reset.
+		uint32_t getUsed() const
+		{
+			return m_used;
+		}
+
+		/// Number of overflow blocks allocated since last reset.
+		uint32_t getNumOverflows() const
+		{
+			return m_numOverflows;
+		}
+
+	private:
+		struct Block
+		{
+			Block* m_next;
+			uint32_t m_size;
+			uint32_t m_pos;
+		};
+
+		bx::AllocatorI* m_allocator;
+		uint8_t* m_data;
+		Block* m_overflow;
+		uint32_t m_size;
+		uint32_t m_pos;
+		uint32_t m_used;
+		uint32_t m_numOverflows;
+	};
+
+} // namespace max
+
+#endif // MAX_ECS_H_HEADER_GUARD
@@ -80,7 +80,6 @@ namespace max
 
 	max::NativeWindowHandleType::Enum getNativeWindowHandleType()
 	{
-		BX_UNUSED(_handle);
 		return max::NativeWindowHandleType::Default;
 	}
 
@@ -88,7 +87,7 @@ namespace max
 
 int main(int _argc, const char* const* _argv)
 {
-	return entry::main(_argc, _argv);
+	return max::main(_argc, _argv);
 }
 
 #endif // MAX_CONFIG_USE_NOOP
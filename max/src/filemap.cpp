@@ -0,0 +1,212 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#include <bx/cpu.h>
+#include <bx/debug.h>
+#include <bx/file.h>
+
+#include "filemap.h"
+
+#if BX_PLATFORM_WINDOWS
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif // WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#	define MAX_FILEMAP_MMAP 1
+#elif BX_PLATFORM_POSIX && !BX_PLATFORM_EMSCRIPTEN
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	define MAX_FILEMAP_MMAP 1
+#else
+#	define MAX_FILEMAP_MMAP 0
+#endif // BX_PLATFORM_*
+
+namespace max
+{
+	FileMap::FileMap()
+		: m_allocator(NULL)
+		, m_data(NULL)
+		, m_size(0)
+		, m_refCount(1)
+	{
+	}
+
+	FileMap* FileMap::open(const char* _filePath, bx::AllocatorI* _allocator)
+	{
+		FileMap* map = BX_NEW(_allocator, FileMap);
+		map->m_allocator = _allocator;
+
+		if (!map->map(_filePath) )
+		{
+			BX_TRACE("Failed to map %s.", _filePath);
+			bx::deleteObject(_allocator, map);
+			return NULL;
+		}
+
+		return map;
+	}
+
+	void FileMap::addRef()
+	{
+		bx::atomicFetchAndAdd<int32_t>(&m_refCount, 1);
+	}
+
+	void FileMap::release()
+	{
+		if (1 == bx::atomicFetchAndSub<int32_t>(&m_refCount, 1) )
+		{
+			unmap();
+			bx::deleteObject(m_allocator, this);
+		}
+	}
+
+	const Memory* FileMap::makeRef(const void* _data, uint32_t _size)
+	{
+		BX_ASSERT(_data >= m_data && (const uint8_t*)_data + _size <= m_data + m_size
+			, "Memory range is outside of file mapping."
+			);
+
+		addRef();
+		return max::makeRef(_data, _size, releaseFn, this);
+	}
+
+	void FileMap::releaseFn(void* /*_ptr*/, void* _userData)
+	{
+		FileMap* map = (FileMap*)_userData;
+		map->release();
+	}
+
+#if BX_PLATFORM_WINDOWS
+	bool FileMap::map(const char* _filePath)
+	{
+		HANDLE file = CreateFileA(
+			  _filePath
+			, GENERIC_READ
+			, FILE_SHARE_READ
+			, NULL
+			, OPEN_EXISTING
+			, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN
+			, NULL
+			);
+
+		if (INVALID_HANDLE_VALUE == file)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size)
+		||  0 == size.QuadPart
+		||  UINT32_MAX < uint64_t(size.QuadPart) )
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+
+		if (NULL == mapping)
+		{
+			return false;
+		}
+
+		// View keeps mapping object alive.
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+
+		if (NULL == data)
+		{
+			return false;
+		}
+
+		m_data = (uint8_t*)data;
+		m_size = uint32_t(size.QuadPart);
+		return true;
+	}
+
+	void FileMap::unmap()
+	{
+		if (NULL != m_data)
+		{
+			UnmapViewOfFile(m_data);
+			m_data = NULL;
+		}
+	}
+#elif MAX_FILEMAP_MMAP
+	bool FileMap::map(const char* _filePath)
+	{
+		const int fd = ::open(_filePath, O_RDONLY);
+		if (0 > fd)
+		{
+			return false;
+		}
+
+		struct stat st;
+		if (0 != fstat(fd, &st)
+		||  0 == st.st_size
+		||  UINT32_MAX < uint64_t(st.st_size) )
+		{
+			::close(fd);
+			return false;
+		}
+
+		// Mapping stays valid after file descriptor is closed.
+		void* data = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+
+		if (MAP_FAILED == data)
+		{
+			return false;
+		}
+
+		m_data = (uint8_t*)data;
+		m_size = uint32_t(st.st_size);
+		return true;
+	}
+
+	void FileMap::unmap()
+	{
+		if (NULL != m_data)
+		{
+			munmap(m_data, m_size);
+			m_data = NULL;
+		}
+	}
+#else
+	bool FileMap::map(const char* _filePath)
+	{
+		bx::FileReader reader;
+		if (!bx::open(&reader, _filePath) )
+		{
+			return false;
+		}
+
+		m_size = uint32_t(bx::getSize(&reader) );
+		m_data = (uint8_t*)bx::alloc(m_allocator, m_size);
+
+		bx::Error err;
+		bx::read(&reader, m_data, m_size, &err);
+		bx::close(&reader);
+
+		if (!err.isOk() )
+		{
+			unmap();
+			return false;
+		}
+
+		return true;
+	}
+
+	void FileMap::unmap()
+	{
+		bx::free(m_allocator, m_data);
+		m_data = NULL;
+	}
+#endif // BX_PLATFORM_WINDOWS
+
+} // namespace max
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#ifndef MAX_FILEMAP_H_HEADER_GUARD
+#define MAX_FILEMAP_H_HEADER_GUARD
+
+#include <max/max.h>
+#include <bx/allocator.h>
+
+namespace max
+{
+	/// Read-only memory mapped file.
+	///
+	/// Mapping is reference counted, ranges of it can be passed to renderer
+	/// with `makeRef` and file is unmapped once all references are released.
+	/// On platforms without memory mapping whole file is read into memory.
+	///
+	class FileMap
+	{
+	public:
+		/// Map file, returns NULL if file can't be opened. Returned mapping
+		/// has one reference.
+		static FileMap* open(const char* _filePath, bx::AllocatorI* _allocator);
+
+		///
+		void addRef();
+
+		/// Release reference, unmaps file when last reference is released.
+		/// Thread safe.
+		void release();
+
+		/// Returns memory reference to range of mapping. Mapping is kept alive
+		/// until memory is released.
+		const Memory* makeRef(const void* _data, uint32_t _size);
+
+		///
+		const uint8_t* getData() const
+		{
+			return m_data;
+		}
+
+		///
+		uint32_t getSize() const
+		{
+			return m_size;
+		}
+
+	private:
+		FileMap();
+
+		bool map(const char* _filePath);
+		void unmap();
+
+		static void releaseFn(void* _ptr, void* _userData);
+
+		bx::AllocatorI* m_allocator;
+		uint8_t* m_data;
+		uint32_t m_size;
+		int32_t  m_refCount;
+	};
+
+} // namespace max
+
+#endif // MAX_FILEMAP_H_HEADER_GUARD
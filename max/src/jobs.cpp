@@ -0,0 +1,259 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#include <bx/cpu.h>
+#include <bx/debug.h>
+#include <bx/math.h>
+
+#include "jobs.h"
+
+#if BX_CONFIG_SUPPORTS_THREADING
+#	include <thread>
+#endif // BX_CONFIG_SUPPORTS_THREADING
+
+namespace max
+{
+	struct RangeJob
+	{
+		JobRangeFn m_fn;
+		void* m_userData;
+		uint32_t m_begin;
+		uint32_t m_end;
+		int32_t* m_remaining;
+		bx::Semaphore* m_done;
+	};
+
+	static void rangeJob(void* _userData)
+	{
+		RangeJob& job = *(RangeJob*)_userData;
+		job.m_fn(job.m_begin, job.m_end, job.m_userData);
+
+		if (1 == bx::atomicFetchAndSub<int32_t>(job.m_remaining, 1) )
+		{
+			job.m_done->post();
+		}
+	}
+
+	uint32_t jobGetDefaultNumThreads()
+	{
+#if BX_CONFIG_SUPPORTS_THREADING
+		const uint32_t numCores = std::thread::hardware_concurrency();
+		return bx::min<uint32_t>(numCores > 1 ? numCores - 1 : 0, MAX_CONFIG_MAX_JOB_THREADS);
+#else
+		return 0;
+#endif // BX_CONFIG_SUPPORTS_THREADING
+	}
+
+	JobPool::JobPool()
+		: m_read(0)
+		, m_write(0)
+		, m_numThreads(0)
+		, m_exit(false)
+	{
+	}
+
+	void JobPool::init(uint32_t _numThreads, const char* _name)
+	{
+		m_read = 0;
+		m_write = 0;
+		m_exit = false;
+
+#if BX_CONFIG_SUPPORTS_THREADING
+		m_numThreads = bx::min<uint32_t>(_numThreads, MAX_CONFIG_MAX_JOB_THREADS);
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].init(workerThread, this, 0, _name);
+		}
+#else
+		BX_UNUSED(_numThreads, _name);
+		m_numThreads = 0;
+#endif // BX_CONFIG_SUPPORTS_THREADING
+	}
+
+	void JobPool::shutdown()
+	{
+		while (execute() ) {};
+
+		{
+			bx::MutexScope lock(m_lock);
+			m_exit = true;
+		}
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_sem.post();
+		}
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].shutdown();
+		}
+
+		m_numThreads = 0;
+	}
+
+	void JobPool::dispatch(JobFn _fn, void* _userData)
+	{
+		if (0 != m_numThreads)
+		{
+			bx::MutexScope lock(m_lock);
+
+			if (m_write - m_read < MAX_CONFIG_MAX_JOBS)
+			{
+				Job& job = m_jobs[m_write % MAX_CONFIG_MAX_JOBS];
+				job.m_fn = _fn;
+				job.m_userData = _userData;
+				++m_write;
+
+				m_sem.post();
+				return;
+			}
+
+			BX_TRACE("Job queue is full, executing job on calling thread.");
+		}
+
+		_fn(_userData);
+	}
+
+	bool JobPool::execute()
+	{
+		Job job;
+
+		{
+			bx::MutexScope lock(m_lock);
+
+			// Skip jobs already taken by `executeOwn`.
+			do
+			{
+				if (m_read == m_write)
+				{
+					return false;
+				}
+
+				job = m_jobs[m_read % MAX_CONFIG_MAX_JOBS];
+				++m_read;
+			}
+			while (NULL == job.m_fn);
+		}
+
+		job.m_fn(job.m_userData);
+
+		return true;
+	}
+
+	bool JobPool::executeOwn(const void* _first, const void* _last)
+	{
+		Job job;
+		job.m_fn = NULL;
+
+		{
+			bx::MutexScope lock(m_lock);
+
+			for (uint32_t ii = m_read; ii != m_write; ++ii)
+			{
+				Job& queued = m_jobs[ii % MAX_CONFIG_MAX_JOBS];
+				if (NULL != queued.m_fn
+				&&  queued.m_userData >= _first
+				&&  queued.m_userData <  _last)
+				{
+					job = queued;
+
+					// Leave empty slot behind, it's skipped by `execute`.
+					queued.m_fn = NULL;
+					break;
+				}
+			}
+		}
+
+		if (NULL == job.m_fn)
+		{
+			return false;
+		}
+
+		job.m_fn(job.m_userData);
+
+		return true;
+	}
+
+	void JobPool::parallelFor(uint32_t _num, uint32_t _grain, uint32_t _maxRanges, JobRangeFn _fn, void* _userData)
+	{
+		if (0 == _num)
+		{
+			return;
+		}
+
+		const uint32_t grain = bx::max<uint32_t>(_grain, 1);
+
+		uint32_t numRanges = (_num + grain - 1) / grain;
+		numRanges = bx::min<uint32_t>(numRanges, m_numThreads + 1);
+		numRanges = bx::min<uint32_t>(numRanges, _maxRanges);
+		numRanges = bx::max<uint32_t>(numRanges, 1);
+
+		if (1 == numRanges)
+		{
+			_fn(0, _num, _userData);
+			return;
+		}
+
+		RangeJob jobs[MAX_CONFIG_MAX_JOB_THREADS + 1];
+		int32_t remaining = int32_t(numRanges);
+		bx::Semaphore done;
+
+		const uint32_t step = _num / numRanges;
+		const uint32_t rest = _num % numRanges;
+
+		uint32_t begin = 0;
+		for (uint32_t ii = 0; ii < numRanges; ++ii)
+		{
+			const uint32_t end = begin + step + (ii < rest ? 1 : 0);
+
+			RangeJob& job = jobs[ii];
+			job.m_fn = _fn;
+			job.m_userData = _userData;
+			job.m_begin = begin;
+			job.m_end = end;
+			job.m_remaining = &remaining;
+			job.m_done = &done;
+
+			begin = end;
+		}
+
+		for (uint32_t ii = 1; ii < numRanges; ++ii)
+		{
+			dispatch(rangeJob, &jobs[ii]);
+		}
+
+		// Calling thread takes first range, then helps with rest of its own
+		// ranges still in queue. Other queued jobs are left to workers, so
+		// caller doesn't end up running unrelated long jobs.
+		rangeJob(&jobs[0]);
+		while (executeOwn(&jobs[1], &jobs[numRanges]) ) {};
+
+		done.wait();
+	}
+
+	int32_t JobPool::workerThread(bx::Thread* /*_self*/, void* _userData)
+	{
+		JobPool* pool = (JobPool*)_userData;
+
+		for (;;)
+		{
+			pool->m_sem.wait();
+
+			{
+				bx::MutexScope lock(pool->m_lock);
+				if (pool->m_exit)
+				{
+					break;
+				}
+			}
+
+			pool->execute();
+		}
+
+		return bx::kExitSuccess;
+	}
+
+} // namespace max
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#ifndef MAX_JOBS_H_HEADER_GUARD
+#define MAX_JOBS_H_HEADER_GUARD
+
+#include <bx/mutex.h>
+#include <bx/semaphore.h>
+#include <bx/thread.h>
+
+#include "config.h"
+
+namespace max
+{
+	/// Job callback.
+	typedef void (*JobFn)(void* _userData);
+
+	/// Range job callback, called with `[_begin, _end)` item range.
+	typedef void (*JobRangeFn)(uint32_t _begin, uint32_t _end, void* _userData);
+
+	/// Fixed size worker thread pool.
+	///
+	/// Jobs are pushed into single FIFO queue. With zero worker threads, or
+	/// when queue is full, jobs are executed on calling thread. Thread
+	/// waiting in `parallelFor` only helps with its own ranges, so it's never
+	/// stalled by unrelated jobs.
+	///
+	class JobPool
+	{
+	public:
+		///
+		JobPool();
+
+		///
+		void init(uint32_t _numThreads, const char* _name);
+
+		/// Waits for pending jobs and joins worker threads.
+		void shutdown();
+
+		/// Push job into queue.
+		void dispatch(JobFn _fn, void* _userData);
+
+		/// Execute single pending job on calling thread. Returns false if
+		/// queue was empty.
+		bool execute();
+
+		/// Split `_num` items into ranges of at least `_grain` items, run them
+		/// across worker threads and calling thread, and block until all
+		/// ranges are done. At most `_maxRanges` ranges are created. Calling
+		/// thread executes only ranges of this call, never other queued jobs.
+		void parallelFor(uint32_t _num, uint32_t _grain, uint32_t _maxRanges, JobRangeFn _fn, void* _userData);
+
+		///
+		uint32_t getNumThreads() const
+		{
+			return m_numThreads;
+		}
+
+	private:
+		struct Job
+		{
+			JobFn m_fn;
+			void* m_userData;
+		};
+
+		/// Take pending job with user data in `[_first, _last)` out of queue
+		/// and execute it on calling thread. Returns false if there was none.
+		bool executeOwn(const void* _first, const void* _last);
+
+		static int32_t workerThread(bx::Thread* _self, void* _userData);
+
+		bx::Thread    m_thread[MAX_CONFIG_MAX_JOB_THREADS];
+		bx::Mutex     m_lock;
+		bx::Semaphore m_sem;
+		Job           m_jobs[MAX_CONFIG_MAX_JOBS];
+		uint32_t      m_read;
+		uint32_t      m_write;
+		uint32_t      m_numThreads;
+		bool          m_exit;
+	};
+
+	/// Returns number of worker threads to use, leaving one hardware thread
+	/// for calling thread.
+	uint32_t jobGetDefaultNumThreads();
+
+} // namespace max
+
+#endif // MAX_JOBS_H_HEADER_GUARD
@@ -471,11 +471,7 @@ namespace max
 		const float time = (float)((now - s_timeOffset) / double(bx::getHPFrequency()));
 		s_deltaTime = float(frameTime / freq);
 
-		//
-		if (s_ctx->m_physicsCtx != NULL)
-		{
-			s_ctx->m_physicsCtx->simulate(s_deltaTime);
-		}
+		s_ctx->physicsUpdate(s_deltaTime);
 
 		return true;
 	}
@@ -2512,6 +2508,34 @@ namespace max
 		}
 	}
 
+	void dbgDrawLineList(ViewId _viewId, const DebugPosVertex* _vertices, uint32_t _num)
+	{
+		const uint32_t num = bx::min(_num, getAvailTransientVertexBuffer(_num, DebugPosVertex::ms_layout) ) & ~UINT32_C(1);
+		if (0 == num)
+		{
+			return;
+		}
+
+		BX_WARN(num == _num, "Not enough space in transient vertex buffer, dropped %d debug lines.", (_num - num) / 2);
+
+		TransientVertexBuffer tvb;
+		allocTransientVertexBuffer(&tvb, num, DebugPosVertex::ms_layout);
+		bx::memCopy(tvb.data, _vertices, num * DebugPosVertex::ms_layout.m_stride);
+
+		Encoder* encoder = begin();
+		encoder->setVertexBuffer(0, &tvb);
+		encoder->setState(0
+			| MAX_STATE_WRITE_RGB
+			| MAX_STATE_WRITE_Z
+			| MAX_STATE_DEPTH_TEST_LESS
+			| MAX_STATE_PT_LINES
+			| MAX_STATE_LINEAA
+			| MAX_STATE_BLEND_ALPHA
+			);
+		encoder->submit(_viewId, s_dds.m_program[DebugProgram::Lines]);
+		end(encoder);
+	}
+
 	void DebugDrawEncoderImpl::flushQuad()
 	{
 		if (0 != m_posQuad)
@@ -3233,6 +3257,262 @@ namespace max
 	///
 	void physicsDestroy(PhysicsContextI* _physicsCtx);
 
+	void Context::physicsInit(const Init& _init)
+	{
+		m_physicsStep           = 1.0f / float(_init.physics.stepRate);
+		m_physicsMaxSubsteps    = _init.physics.maxSubsteps;
+		m_physicsCollisionSteps = _init.physics.collisionSteps;
+		m_physicsAccumulator    = 0.0f;
+		m_physicsNumSteps       = 0;
+		m_physicsRead           = 0;
+		m_physicsPending        = false;
+		m_physicsExit           = false;
+		m_physicsFrame[0].m_alpha = 0.0f;
+		m_physicsFrame[1].m_alpha = 0.0f;
+
+		if (NULL == m_physicsCtx)
+		{
+			return;
+		}
+
+#if MAX_CONFIG_MULTITHREADED
+		m_physicsThread.init(physicsThread, this, 0, "max - Physics");
+#endif // MAX_CONFIG_MULTITHREADED
+	}
+
+	void Context::physicsShutdown()
+	{
+		if (NULL == m_physicsCtx)
+		{
+			return;
+		}
+
+#if MAX_CONFIG_MULTITHREADED
+		if (m_physicsPending)
+		{
+			m_physicsDoneSem.wait();
+			m_physicsPending = false;
+		}
+
+		m_physicsExit = true;
+		m_physicsKickSem.post();
+		m_physicsThread.shutdown();
+#endif // MAX_CONFIG_MULTITHREADED
+
+		m_physicsCommands.clear();
+	}
+
+	void Context::physicsUpdate(float _dt)
+	{
+		if (NULL == m_physicsCtx)
+		{
+			return;
+		}
+
+		MAX_PROFILER_SCOPE("max/Physics update", 0xff2040ff);
+
+#if MAX_CONFIG_MULTITHREADED
+		physicsSync();
+
+		// Events of published batch, or none when there was no batch.
+		m_physicsCtx->publishEvents();
+#endif // MAX_CONFIG_MULTITHREADED
+
+		// Physics thread is idle here, safe to touch physics world from
+		// game thread.
+		if (0 != (m_debug & MAX_DEBUG_PHYSICS) )
+		{
+			m_physicsCtx->debugDraw(MAX_CONFIG_DEBUG_PHYSICS_VIEW);
+		}
+
+		// Clamp accumulated time, after frame spike simulation slows down
+		// instead of trying to catch up with ever growing number of steps.
+		const float maxTime = m_physicsStep * float(m_physicsMaxSubsteps);
+		m_physicsAccumulator = bx::min(m_physicsAccumulator + _dt, maxTime);
+
+		m_physicsNumSteps     = uint32_t(m_physicsAccumulator / m_physicsStep);
+		m_physicsAccumulator -= float(m_physicsNumSteps) * m_physicsStep;
+
+		// Alpha belongs to frame it interpolates, batch kicked now is
+		// published next frame together with its alpha.
+		PhysicsFrame& frame = 0 != m_physicsNumSteps
+			? m_physicsFrame[m_physicsRead ^ 1]
+			: m_physicsFrame[m_physicsRead]
+			;
+		frame.m_alpha = bx::clamp(m_physicsAccumulator / m_physicsStep, 0.0f, 1.0f);
+
+#if MAX_CONFIG_MULTITHREADED
+		if (0 != m_physicsNumSteps)
+		{
+			m_physicsPending = true;
+			m_physicsKickSem.post();
+		}
+#else
+		if (0 != m_physicsNumSteps)
+		{
+			physicsStep();
+			m_physicsRead ^= 1;
+		}
+
+		m_physicsCtx->publishEvents();
+#endif // MAX_CONFIG_MULTITHREADED
+	}
+
+	void Context::physicsSync()
+	{
+#if MAX_CONFIG_MULTITHREADED
+		// Publish batch kicked last frame.
+		if (m_physicsPending)
+		{
+			m_physicsDoneSem.wait();
+			m_physicsPending = false;
+			m_physicsRead ^= 1;
+
+			physicsReplay();
+		}
+#endif // MAX_CONFIG_MULTITHREADED
+	}
+
+	void Context::physicsReplay()
+	{
+		for (uint32_t ii = 0, num = uint32_t(m_physicsCommands.size() ); ii < num; ++ii)
+		{
+			const PhysicsCommand& cmd = m_physicsCommands[ii];
+			const BodyHandle handle = cmd.m_handle;
+			if (!isValid(handle) )
+			{
+				// Body was destroyed.
+				continue;
+			}
+
+			const float* data = cmd.m_data;
+			const Activation::Enum activation = Activation::Enum(cmd.m_activation);
+
+			switch (cmd.m_type)
+			{
+			case PhysicsCommand::SetPosition:
+				m_physicsCtx->setPosition(handle, bx::load<bx::Vec3>(&data[0]), activation);
+				break;
+
+			case PhysicsCommand::SetRotation:
+				m_physicsCtx->setRotation(handle, bx::load<bx::Quaternion>(&data[0]), activation);
+				break;
+
+			case PhysicsCommand::SetLinearVelocity:
+				m_physicsCtx->setLinearVelocity(handle, bx::load<bx::Vec3>(&data[0]) );
+				break;
+
+			case PhysicsCommand::SetAngularVelocity:
+				m_physicsCtx->setAngularVelocity(handle, bx::load<bx::Vec3>(&data[0]) );
+				break;
+
+			case PhysicsCommand::AddLinearAndAngularVelocity:
+				m_physicsCtx->addLinearAndAngularVelocity(handle, bx::load<bx::Vec3>(&data[0]), bx::load<bx::Vec3>(&data[3]) );
+				break;
+
+			case PhysicsCommand::AddLinearImpulse:
+				m_physicsCtx->addLinearImpulse(handle, bx::load<bx::Vec3>(&data[0]) );
+				break;
+
+			case PhysicsCommand::AddAngularImpulse:
+				m_physicsCtx->addAngularImpulse(handle, bx::load<bx::Vec3>(&data[0]) );
+				break;
+
+			case PhysicsCommand::AddBuoyancyImpulse:
+				m_physicsCtx->addBuoyancyImpulse(
+					  handle
+					, bx::load<bx::Vec3>(&data[0])
+					, bx::load<bx::Vec3>(&data[3])
+					, data[6]
+					, data[7]
+					, data[8]
+					, bx::load<bx::Vec3>(&data[9])
+					, bx::load<bx::Vec3>(&data[12])
+					, data[15]
+					);
+				break;
+
+			case PhysicsCommand::AddForce:
+				m_physicsCtx->addForce(handle, bx::load<bx::Vec3>(&data[0]), activation);
+				break;
+
+			case PhysicsCommand::AddTorque:
+				m_physicsCtx->addTorque(handle, bx::load<bx::Vec3>(&data[0]), activation);
+				break;
+
+			case PhysicsCommand::AddMovement:
+				m_physicsCtx->addMovement(handle, bx::load<bx::Vec3>(&data[0]), bx::load<bx::Quaternion>(&data[3]), data[7]);
+				break;
+
+			case PhysicsCommand::SetFriction:
+				m_physicsCtx->setFriction(handle, data[0]);
+				break;
+
+			default:
+				BX_ASSERT(false, "Invalid physics command %d.", cmd.m_type);
+				break;
+			}
+		}
+
+		m_physicsCommands.clear();
+	}
+
+	void Context::physicsSeedTransforms()
+	{
+		PhysicsFrame& frame = m_physicsFrame[0];
+		m_physicsCtx->getBodyTransforms(frame.m_curr);
+		bx::memCopy(frame.m_prev, frame.m_curr, sizeof(frame.m_curr) );
+		bx::memCopy(&m_physicsFrame[1], &frame, sizeof(frame) );
+	}
+
+	void Context::physicsStep()
+	{
+		// Writes into frame that is not published, game thread only reads
+		// published frame.
+		PhysicsFrame& frame = m_physicsFrame[m_physicsRead ^ 1];
+
+		for (uint32_t ii = 0; ii < m_physicsNumSteps; ++ii)
+		{
+			MAX_MUTEX_SCOPE(m_physicsLock);
+
+			if (ii + 1 == m_physicsNumSteps)
+			{
+				m_physicsCtx->getBodyTransforms(frame.m_prev);
+			}
+
+			m_physicsCtx->simulate(m_physicsStep, m_physicsCollisionSteps);
+		}
+
+		MAX_MUTEX_SCOPE(m_physicsLock);
+		m_physicsCtx->getBodyTransforms(frame.m_curr);
+	}
+
+#if MAX_CONFIG_MULTITHREADED
+	int32_t Context::physicsThread(bx::Thread* /*_self*/, void* _userData)
+	{
+		BX_TRACE("physics thread start");
+		MAX_PROFILER_SET_CURRENT_THREAD_NAME("max - Physics Thread");
+
+		Context* ctx = (Context*)_userData;
+
+		for (;;)
+		{
+			ctx->m_physicsKickSem.wait();
+
+			if (ctx->m_physicsExit)
+			{
+				break;
+			}
+
+			ctx->physicsStep();
+			ctx->m_physicsDoneSem.post();
+		}
+
+		BX_TRACE("physics thread exit");
+		return bx::kExitSuccess;
+	}
+#endif // MAX_CONFIG_MULTITHREADED
+
 	bool Context::init(const Init& _init)
 	{
 		if (m_rendererInitialized)
@@ -3405,14 +3685,26 @@ namespace max
 		g_internalData.caps = getCaps();
 
 		m_physicsCtx = physicsCreate(_init);
+		physicsInit(_init);
 
 		resetInput();
 
 		s_dds.init();
 		s_dde.init( begin(false) );
 
+		m_jobPool.init(MAX_CONFIG_MULTITHREADED ? jobGetDefaultNumThreads() : 0, "max - Worker");
+		m_ioJobPool.init(MAX_CONFIG_MULTITHREADED ? MAX_CONFIG_NUM_IO_THREADS : 0, "max - I/O");
+
+		m_entityHandle.init(_init.limits.entityPoolSize, g_allocator);
+		m_entityRef.init(_init.limits.entityPoolSize, g_allocator);
+		m_componentHandle.init(_init.limits.componentPoolSize, g_allocator);
+		m_componentRef.init(_init.limits.componentPoolSize, g_allocator);
+		m_archetypes.init(0, g_allocator);
+		m_entityQueryRef.init(0, g_allocator);
+
+		m_queryArena.init(MAX_CONFIG_ECS_QUERY_ARENA_SIZE, g_allocator);
+
 		// @todo Move elsewhere? 
-		m_entityQuery.alloc(MAX_CONFIG_MAX_ENTITIES);
 		m_meshQuery.alloc(MAX_CONFIG_MAX_MESH_GROUPS);
 
 		return true;
@@ -3421,12 +3713,42 @@ namespace max
 	void Context::shutdown()
 	{
 		// @todo Move elsewhere? 
-		m_entityQuery.free();
 		m_meshQuery.free();
 
+		m_queryArena.shutdown();
+
+		m_ioJobPool.shutdown();
+		asyncLoadShutdown();
+
+		m_jobPool.shutdown();
+
+		for (uint16_t ii = 0; ii < m_numArchetypes; ++ii)
+		{
+			m_archetypes[ii].destroy();
+		}
+		m_archetypes.shutdown();
+		m_archetypeHashMap.reset();
+		m_numArchetypes = 0;
+
+		for (uint16_t ii = 0; ii < m_numEntityQueries; ++ii)
+		{
+			m_entityQueryRef[ii].destroy();
+		}
+		m_entityQueryRef.shutdown();
+		m_entityQueryTemp.destroy();
+		m_entityQueryHashMap.reset();
+		m_numEntityQueries = 0;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_entityCommands); ++ii)
+		{
+			m_entityCommands[ii].shutdown();
+		}
+		m_entityCommandsRemap.clear();
+
 		s_dde.shutdown();
 		s_dds.shutdown();
 
+		physicsShutdown();
 		physicsDestroy(m_physicsCtx);
 
 		getCommandBuffer(CommandBuffer::RendererShutdownBegin);
@@ -3576,6 +3898,11 @@ namespace max
 #undef CHECK_HANDLE_LEAK
 #undef CHECK_HANDLE_LEAK_NAME
 		}
+
+		m_entityRef.shutdown();
+		m_entityHandle.shutdown();
+		m_componentRef.shutdown();
+		m_componentHandle.shutdown();
 	}
 
 	void Context::freeDynamicBuffers()
@@ -3603,6 +3930,11 @@ namespace max
 			m_bodyHandle.free(m_freeBodyHandle[ii].idx);
 		}
 		m_numFreeBodyHandles = 0;
+
+		// Entities and components destroyed during frame can be reused from
+		// next frame on.
+		m_entityHandle.releasePending();
+		m_componentHandle.releasePending();
 	}
 
 	void Context::freeAllHandles(Frame* _frame)
@@ -3651,16 +3983,6 @@ namespace max
 		{
 			m_meshHandle.free(_frame->m_freeMesh.get(ii).idx);
 		}
-
-		for (uint16_t ii = 0, num = _frame->m_freeComponent.getNumQueued(); ii < num; ++ii)
-		{
-			m_componentHandle.free(_frame->m_freeComponent.get(ii).idx);
-		}
-
-		for (uint16_t ii = 0, num = _frame->m_freeEntity.getNumQueued(); ii < num; ++ii)
-		{
-			m_entityHandle.free(_frame->m_freeEntity.get(ii).idx);
-		}
 	}
 
 	Encoder* Context::begin(bool _forThread)
@@ -3704,6 +4026,8 @@ namespace max
 
 	uint32_t Context::frame(bool _capture)
 	{
+		entityCommandsFlush();
+
 		m_encoder[0].end(true);
 
 #if MAX_CONFIG_MULTITHREADED
@@ -3715,6 +4039,11 @@ namespace max
 		encoderApiWait();
 #endif // MAX_CONFIG_MULTITHREADED
 
+		// Query results are only valid until end of frame.
+		m_queryArena.reset();
+
+		asyncLoadUpdate();
+
 		m_submit->m_capture = _capture;
 
 		uint32_t frameNum = m_submit->m_frameNum;
@@ -4901,7 +5230,38 @@ namespace max
 		, minResourceCbSize(MAX_CONFIG_MIN_RESOURCE_COMMAND_BUFFER_SIZE)
 		, transientVbSize(MAX_CONFIG_TRANSIENT_VERTEX_BUFFER_SIZE)
 		, transientIbSize(MAX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE)
-	{
+		, entityPoolSize(MAX_CONFIG_DEFAULT_ENTITY_POOL_SIZE)
+		, componentPoolSize(MAX_CONFIG_DEFAULT_COMPONENT_POOL_SIZE)
+		, asyncUploadBudget(MAX_CONFIG_ASYNC_UPLOAD_BUDGET)
+	{
+	}
+
+	Init::Physics::Physics()
+		: stepRate(MAX_CONFIG_PHYSICS_STEP_RATE)
+		, maxSubsteps(MAX_CONFIG_PHYSICS_MAX_SUBSTEPS)
+		, collisionSteps(1)
+		, numThreads(UINT8_MAX)
+		, tempAllocatorSize(MAX_CONFIG_PHYSICS_TEMP_ALLOCATOR_SIZE)
+		, maxBodies(MAX_CONFIG_MAX_BODIES)
+		, maxBodyPairs(MAX_CONFIG_MAX_BODY_PAIRS)
+		, maxContactConstraints(MAX_CONFIG_MAX_CONTACT_CONSTRAINTS)
+		, numBodyMutexes(0)
+	{
+		gravity[0] =   0.0f;
+		gravity[1] = -10.0f;
+		gravity[2] =   0.0f;
+
+		layerMask[LayerType::NonMoving] = 0
+			| (1<<LayerType::Moving)
+			| (1<<LayerType::Debris)
+			;
+		layerMask[LayerType::Moving] = 0
+			| (1<<LayerType::NonMoving)
+			| (1<<LayerType::Moving)
+			| (1<<LayerType::Trigger)
+			;
+		layerMask[LayerType::Debris]  = 1<<LayerType::NonMoving;
+		layerMask[LayerType::Trigger] = 1<<LayerType::Moving;
 	}
 
 	Init::Init()
@@ -4939,6 +5299,11 @@ namespace max
 
 		init.limits.maxEncoders       = bx::clamp<uint16_t>(init.limits.maxEncoders, 1, (0 != MAX_CONFIG_MULTITHREADED) ? 128 : 1);
 		init.limits.minResourceCbSize = bx::min<uint32_t>(init.limits.minResourceCbSize, MAX_CONFIG_MIN_RESOURCE_COMMAND_BUFFER_SIZE);
+		init.physics.stepRate         = bx::max<uint16_t>(init.physics.stepRate, 1);
+		init.physics.maxSubsteps      = bx::max<uint8_t>(init.physics.maxSubsteps, 1);
+		init.physics.collisionSteps   = bx::max<uint8_t>(init.physics.collisionSteps, 1);
+		init.physics.maxBodies        = bx::clamp<uint32_t>(init.physics.maxBodies, 1, MAX_CONFIG_MAX_BODIES);
+		init.physics.tempAllocatorSize = bx::max<uint32_t>(init.physics.tempAllocatorSize, 64<<10);
 
 		struct ErrorState
 		{
@@ -7042,6 +7407,223 @@ namespace max
 		return handle;
 	}
 
+	TextureHandle loadTextureAsync(const char* _filePath, uint64_t _flags, uint8_t _skip)
+	{
+		return s_ctx->loadTextureAsync(_filePath, _flags, _skip);
+	}
+
+	LoadState::Enum getLoadState(TextureHandle _handle)
+	{
+		return s_ctx->getLoadState(_handle);
+	}
+
+	TextureHandle Context::loadTextureAsync(const char* _filePath, uint64_t _flags, uint8_t _skip)
+	{
+		MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+		if (m_asyncLoadHandle.getNumHandles() == m_asyncLoadHandle.getMaxHandles() )
+		{
+			BX_TRACE("Too many asynchronous loads in flight.");
+			return MAX_INVALID_HANDLE;
+		}
+
+		const uint32_t placeholder = UINT32_C(0xff808080);
+		TextureHandle handle = createTexture2D(1, 1, false, 1, TextureFormat::RGBA8, _flags, copy(&placeholder, sizeof(placeholder) ) );
+
+		if (isValid(handle) )
+		{
+			const bx::StringView name(_filePath);
+			setName(handle, name);
+
+			TextureRef& ref = m_textureRef[handle.idx];
+			ref.m_loadState = uint8_t(LoadState::Pending);
+			ref.m_asyncLoad = asyncLoadDispatch(AsyncLoad::Type::Texture, handle.idx, _filePath, _flags, _skip, false);
+		}
+
+		return handle;
+	}
+
+	void Context::asyncLoadJob(void* _userData)
+	{
+		AsyncLoad& load = *(AsyncLoad*)_userData;
+
+		int32_t state = AsyncLoad::State::Failed;
+
+		FileMap* map = FileMap::open(load.m_filePath.getCPtr(), g_allocator);
+		if (NULL != map)
+		{
+			if (AsyncLoad::Type::Mesh == load.m_type)
+			{
+				load.m_hash = bx::hash<bx::HashMurmur2A>(map->getData(), map->getSize() );
+
+				const Memory* mem = map->makeRef(map->getData(), map->getSize() );
+				if (meshParse(load.m_mesh, mem, load.m_ramcopy, map, &s_ctx->m_jobPool) )
+				{
+					state = AsyncLoad::State::Loaded;
+				}
+			}
+			else
+			{
+				load.m_image = bimg::imageParse(g_allocator, map->getData(), map->getSize() );
+				if (NULL != load.m_image)
+				{
+					state = AsyncLoad::State::Loaded;
+				}
+			}
+
+			map->release();
+		}
+
+		// Publish result to API thread.
+		bx::atomicCompareAndSwap<int32_t>(&load.m_state, AsyncLoad::State::Loading, state);
+	}
+
+	void Context::asyncLoadRelease(AsyncLoad& _load)
+	{
+		if (NULL != _load.m_image)
+		{
+			bimg::imageFree(_load.m_image);
+			_load.m_image = NULL;
+		}
+
+		meshDataRelease(_load.m_mesh);
+	}
+
+	void Context::asyncLoadFinish(const AsyncLoad& _load, LoadState::Enum _state)
+	{
+		if (AsyncLoad::Type::Mesh == _load.m_type)
+		{
+			MeshRef& mr = m_meshRef[_load.m_handle];
+			mr.m_asyncLoad = kInvalidHandle;
+			mr.m_loadState = uint8_t(_state);
+		}
+		else
+		{
+			TextureRef& ref = m_textureRef[_load.m_handle];
+			ref.m_asyncLoad = kInvalidHandle;
+			ref.m_loadState = uint8_t(_state);
+		}
+	}
+
+	void Context::asyncLoadUpdate()
+	{
+		const uint32_t budget = m_init.limits.asyncUploadBudget;
+		uint32_t uploaded = 0;
+
+		for (uint16_t ii = 0; ii < m_asyncLoadHandle.getNumHandles();)
+		{
+			const uint16_t idx = m_asyncLoadHandle.getHandleAt(ii);
+			AsyncLoad& load = m_asyncLoads[idx];
+
+			const int32_t state = bx::atomicFetchAndAdd<int32_t>(&load.m_state, 0);
+
+			// Handle might be destroyed and reused while load was in flight.
+			if (!load.m_cancelled)
+			{
+				const uint16_t asyncLoad = AsyncLoad::Type::Mesh == load.m_type
+					? m_meshRef[load.m_handle].m_asyncLoad
+					: m_textureRef[load.m_handle].m_asyncLoad
+					;
+				load.m_cancelled = asyncLoad != idx;
+			}
+
+			// At least one asset is uploaded per frame.
+			if (AsyncLoad::State::Loading == state
+			|| (AsyncLoad::State::Loaded == state && !load.m_cancelled && 0 != uploaded && uploaded >= budget) )
+			{
+				++ii;
+				continue;
+			}
+
+			if (!load.m_cancelled)
+			{
+				if (AsyncLoad::State::Failed == state)
+				{
+					BX_TRACE("Failed to load %s.", load.m_filePath.getCPtr() );
+					asyncLoadFinish(load, LoadState::Failed);
+				}
+				else if (AsyncLoad::Type::Mesh == load.m_type)
+				{
+					MeshRef& mr = m_meshRef[load.m_handle];
+					mr.m_hash = load.m_hash;
+					uploaded += meshCreate(mr, load.m_mesh);
+					asyncLoadFinish(load, LoadState::Ready);
+				}
+				else if (AsyncLoad::State::Swap == state)
+				{
+					// Placeholder was destroyed at end of previous frame, texture
+					// must be created before anything is rendered with it.
+					bimg::ImageContainer* image = load.m_image;
+					load.m_image = NULL;
+
+					const Memory* data = makeRef(image->m_data, image->m_size, imageReleaseCb, image);
+
+					const Memory* mem = alloc(sizeof(uint32_t)+sizeof(TextureCreate) );
+
+					bx::StaticMemoryBlockWriter writer(mem->data, mem->size);
+					uint32_t magic = MAX_CHUNK_MAGIC_TEX;
+					bx::write(&writer, magic, bx::ErrorAssert{});
+
+					TextureCreate tc;
+					tc.m_width     = uint16_t(image->m_width);
+					tc.m_height    = uint16_t(image->m_height);
+					tc.m_depth     = uint16_t(1 < image->m_depth ? image->m_depth : 0);
+					tc.m_numLayers = image->m_numLayers;
+					tc.m_numMips   = image->m_numMips;
+					tc.m_format    = TextureFormat::Enum(image->m_format);
+					tc.m_cubeMap   = image->m_cubeMap;
+					tc.m_mem       = data;
+					bx::write(&writer, tc, bx::ErrorAssert{});
+
+					const TextureHandle handle = { load.m_handle };
+					textureReplace(handle, mem, load.m_flags, load.m_skip);
+				}
+				else
+				{
+					const bimg::ImageContainer& image = *load.m_image;
+
+					if (isTextureValid(
+						  uint16_t(1 < image.m_depth ? image.m_depth : 0)
+						, image.m_cubeMap
+						, image.m_numLayers
+						, TextureFormat::Enum(image.m_format)
+						, load.m_flags
+						) )
+					{
+						// Renderer can't recreate texture in place. Placeholder is
+						// destroyed at end of this frame and texture is created at
+						// start of next one.
+						const TextureHandle handle = { load.m_handle };
+						CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyTexture);
+						cmdbuf.write(handle);
+
+						bx::atomicExchange<int32_t>(&load.m_state, AsyncLoad::State::Swap);
+						uploaded += image.m_size;
+
+						++ii;
+						continue;
+					}
+
+					BX_TRACE("Texture %s is not supported.", load.m_filePath.getCPtr() );
+					asyncLoadFinish(load, LoadState::Failed);
+				}
+			}
+
+			asyncLoadRelease(load);
+			m_asyncLoadHandle.free(idx);
+		}
+	}
+
+	void Context::asyncLoadShutdown()
+	{
+		while (0 != m_asyncLoadHandle.getNumHandles() )
+		{
+			const uint16_t idx = m_asyncLoadHandle.getHandleAt(0);
+			asyncLoadRelease(m_asyncLoads[idx]);
+			m_asyncLoadHandle.free(idx);
+		}
+	}
+
 	bimg::ImageContainer* loadImage(const char* _filePath, TextureFormat::Enum _dstFormat)
 	{
 		uint32_t size = 0;
@@ -7222,14 +7804,40 @@ namespace max
 
 	MeshHandle loadMesh(const char* _filePath, bool _ramcopy)
 	{
-		const Memory* mem = loadMemory(_filePath);
-		MeshHandle handle = s_ctx->createMesh(mem, _ramcopy);
+		// Uncompressed vertex and index chunks are passed to renderer straight
+		// from mapped file, file is unmapped once renderer is done with them.
+		FileMap* map = FileMap::open(_filePath, g_allocator);
+		if (NULL == map)
+		{
+			BX_TRACE("Failed to load %s.", _filePath);
+			return MAX_INVALID_HANDLE;
+		}
+
+		const Memory* mem = map->makeRef(map->getData(), map->getSize() );
+		MeshHandle handle = s_ctx->createMesh(mem, _ramcopy, map);
+		map->release();
+
 		return handle;
 	}
 
-	MeshQuery* queryMesh(MeshHandle _handle)
+	MeshHandle loadMeshAsync(const char* _filePath, bool _ramcopy)
 	{
-		return s_ctx->queryMesh(_handle);
+		return s_ctx->loadMeshAsync(_filePath, _ramcopy);
+	}
+
+	LoadState::Enum getLoadState(MeshHandle _handle)
+	{
+		return s_ctx->getLoadState(_handle);
+	}
+
+	MeshQuery* queryMesh(MeshHandle _handle, uint8_t _lod)
+	{
+		return s_ctx->queryMesh(_handle, _lod);
+	}
+
+	uint8_t getMeshLod(MeshHandle _handle, float _distance, float _projScale, float _threshold)
+	{
+		return s_ctx->getMeshLod(_handle, _distance, _projScale, _threshold);
 	}
 
 	const max::VertexLayout getLayout(MeshHandle _handle)
@@ -7257,19 +7865,115 @@ namespace max
 		return s_ctx->createEntity(_destroyComponents);
 	}
 
+	EntityPrototype::EntityPrototype()
+		: m_num(0)
+	{
+	}
+
+	EntityPrototype& EntityPrototype::begin()
+	{
+		m_num = 0;
+		return *this;
+	}
+
+	EntityPrototype& EntityPrototype::add(ComponentTypeHandle _type, const void* _data, uint32_t _size)
+	{
+		BX_ASSERT(m_num < MaxComponents, "Too many components in entity prototype (max: %d).", MaxComponents);
+		m_types[m_num] = _type;
+		m_data[m_num] = _data;
+		m_size[m_num] = _size;
+		++m_num;
+		return *this;
+	}
+
+	EntityHandle createEntities(uint32_t _num, const EntityPrototype& _prototype, bool _destroyComponents)
+	{
+		return s_ctx->createEntities(_num, _prototype, _destroyComponents);
+	}
+
+	ComponentTypeHandle registerComponentType(uint32_t _hash, uint32_t _size)
+	{
+		return componentTypeRegister(_hash, _size);
+	}
+
+	void addComponent(EntityHandle _entity, ComponentHandle _component, ComponentTypeHandle _type)
+	{
+		s_ctx->addComponent(_entity, _component, _type);
+	}
+
 	void addComponent(EntityHandle _entity, ComponentHandle _component, uint32_t _hash)
 	{
-		s_ctx->addComponent(_entity, _component, _hash);
+		s_ctx->addComponent(_entity, _component, componentTypeRegister(_hash, 0) );
+	}
+
+	void removeComponent(EntityHandle _entity, ComponentTypeHandle _type)
+	{
+		s_ctx->removeComponent(_entity, _type);
+	}
+
+	void removeComponent(EntityHandle _entity, uint32_t _hash)
+	{
+		s_ctx->removeComponent(_entity, componentTypeFind(_hash) );
+	}
+
+	void* getComponent(EntityHandle _handle, ComponentTypeHandle _type, Access::Enum _access)
+	{
+		return s_ctx->getComponent(_handle, _type, _access);
 	}
 
-	void* getComponent(EntityHandle _handle, uint32_t _hash)
+	void* getComponent(EntityHandle _handle, uint32_t _hash, Access::Enum _access)
 	{
-		return s_ctx->getComponent(_handle, _hash);
+		return s_ctx->getComponent(_handle, componentTypeFind(_hash), _access);
+	}
+
+	void markChanged(EntityHandle _entity, ComponentTypeHandle _type)
+	{
+		s_ctx->markChanged(_entity, _type);
+	}
+
+	static uint32_t componentTypesFromHashes(ComponentTypeHandle* _types, const HashQuery& _hashes)
+	{
+		const uint32_t num = bx::min<uint32_t>(_hashes.m_num, MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY);
+		for (uint32_t ii = 0; ii < num; ++ii)
+		{
+			_types[ii] = componentTypeFind(_hashes.m_data[ii]);
+		}
+
+		return num;
+	}
+
+	EntityQuery* queryEntities(const ComponentTypeHandle* _types, uint32_t _num)
+	{
+		return s_ctx->queryEntities(_types, _num);
 	}
 
 	EntityQuery* queryEntities(const HashQuery& _hashes)
 	{
-		return s_ctx->queryEntities(_hashes);
+		ComponentTypeHandle types[MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY];
+		const uint32_t num = componentTypesFromHashes(types, _hashes);
+		return s_ctx->queryEntities(types, num);
+	}
+
+	EntityQuery* queryChangedEntities(const ComponentTypeHandle* _types, uint32_t _num, uint32_t _sinceFrame)
+	{
+		return s_ctx->queryChangedEntities(_types, _num, _sinceFrame);
+	}
+
+	ChunkQuery* queryChunks(const ComponentTypeHandle* _types, uint32_t _num)
+	{
+		return s_ctx->queryChunks(_types, _num);
+	}
+
+	ChunkQuery* queryChunks(const HashQuery& _hashes)
+	{
+		ComponentTypeHandle types[MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY];
+		const uint32_t num = componentTypesFromHashes(types, _hashes);
+		return s_ctx->queryChunks(types, num);
+	}
+
+	void parallelEach(const EntityHandle* _entities, uint32_t _num, SystemParallelFn _func, void* _userData, uint32_t _grain)
+	{
+		s_ctx->parallelEach(_entities, _num, _func, _userData, _grain);
 	}
 
 	void destroy(EntityHandle _entity)
@@ -7277,6 +7981,46 @@ namespace max
 		s_ctx->destroyEntity(_entity);
 	}
 
+	void destroy(EntityHandle _first, uint32_t _num)
+	{
+		s_ctx->destroyEntities(_first, _num);
+	}
+
+#define MAX_ENTITY_COMMANDS(_func) reinterpret_cast<EntityCommandBufferImpl*>(this)->_func
+
+	EntityHandle EntityCommandBuffer::createEntity(bool _destroyComponents)
+	{
+		return MAX_ENTITY_COMMANDS(createEntity(_destroyComponents) );
+	}
+
+	void EntityCommandBuffer::destroy(EntityHandle _entity)
+	{
+		MAX_ENTITY_COMMANDS(destroy(_entity) );
+	}
+
+	void EntityCommandBuffer::addComponent(EntityHandle _entity, ComponentTypeHandle _type, const void* _data, uint32_t _size)
+	{
+		BX_ASSERT(isValid(_type), "Invalid component type.");
+		MAX_ENTITY_COMMANDS(addComponent(_entity, _type, _data, _size) );
+	}
+
+	void EntityCommandBuffer::removeComponent(EntityHandle _entity, ComponentTypeHandle _type)
+	{
+		MAX_ENTITY_COMMANDS(removeComponent(_entity, _type) );
+	}
+
+#undef MAX_ENTITY_COMMANDS
+
+	EntityCommandBuffer* beginEntityCommands()
+	{
+		return s_ctx->beginEntityCommands();
+	}
+
+	void end(EntityCommandBuffer* _commands)
+	{
+		s_ctx->end(_commands);
+	}
+
 	BodyHandle createBody(
 		CollisionShape::Enum _shape,
 		const bx::Vec3& _pos,
@@ -7292,6 +8036,22 @@ namespace max
 		return s_ctx->createBody(_shape, _pos, _quat, _scale, _layer, _motion, _activation, _maxVelocity, _flags);
 	}
 
+	BodyHandle createBody(
+		CollisionShape::Enum _shape,
+		MeshHandle _mesh,
+		const bx::Vec3& _pos,
+		const bx::Quaternion& _quat,
+		const bx::Vec3& _scale,
+		LayerType::Enum _layer,
+		MotionType::Enum _motion,
+		Activation::Enum _activation,
+		float _maxVelocity,
+		uint8_t _flags
+	)
+	{
+		return s_ctx->createBody(_shape, _mesh, _pos, _quat, _scale, _layer, _motion, _activation, _maxVelocity, _flags);
+	}
+
 	BodyHandle createBodySphere(
 		const bx::Vec3& _pos,
 		const bx::Quaternion& _quat,
@@ -7430,6 +8190,41 @@ namespace max
 		s_ctx->addMovement(_handle, _position, _rotation, _deltaTime);
 	}
 
+	void getBodyTransforms(const BodyHandle* _handles, uint32_t _num, bx::Vec3* _positions, bx::Quaternion* _rotations)
+	{
+		s_ctx->getBodyTransforms(_handles, _num, _positions, _rotations);
+	}
+
+	void setPositions(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _positions, Activation::Enum _activation)
+	{
+		s_ctx->setPositions(_handles, _num, _positions, _activation);
+	}
+
+	void addForces(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _forces, Activation::Enum _activation)
+	{
+		s_ctx->addForces(_handles, _num, _forces, _activation);
+	}
+
+	uint32_t getActiveBodies(BodyHandle* _handles, uint32_t _max)
+	{
+		return s_ctx->getActiveBodies(_handles, _max);
+	}
+
+	void rayCast(const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits)
+	{
+		s_ctx->rayCast(_rays, _num, _hits);
+	}
+
+	void shapeCast(CollisionShape::Enum _shape, const bx::Vec3& _scale, const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits)
+	{
+		s_ctx->shapeCast(_shape, _scale, _rays, _num, _hits);
+	}
+
+	void overlap(CollisionShape::Enum _shape, const bx::Vec3& _scale, const bx::Vec3* _positions, uint32_t _num, BodyHandle* _bodies, uint32_t _maxBodies, uint32_t* _numBodies)
+	{
+		s_ctx->overlap(_shape, _scale, _positions, _num, _bodies, _maxBodies, _numBodies);
+	}
+
 	void setFriction(BodyHandle _handle, float _friction)
 	{
 		s_ctx->setFriction(_handle, _friction);
@@ -7455,6 +8250,36 @@ namespace max
 		return s_ctx->getGravity();
 	}
 
+	const ContactEvent* getContactEvents(uint32_t* _num)
+	{
+		return s_ctx->getContactEvents(_num);
+	}
+
+	const ActivationEvent* getActivationEvents(uint32_t* _num)
+	{
+		return s_ctx->getActivationEvents(_num);
+	}
+
+	uint32_t savePhysicsState(void* _data, uint32_t _size, PhysicsState::Enum _state)
+	{
+		return s_ctx->savePhysicsState(_data, _size, _state);
+	}
+
+	bool restorePhysicsState(const void* _data, uint32_t _size)
+	{
+		return s_ctx->restorePhysicsState(_data, _size);
+	}
+
+	float getPhysicsAlpha()
+	{
+		return s_ctx->getPhysicsAlpha();
+	}
+
+	void getInterpolatedTransform(BodyHandle _handle, bx::Vec3& _pos, bx::Quaternion& _rot)
+	{
+		s_ctx->getInterpolatedTransform(_handle, _pos, _rot);
+	}
+
 	// @todo Collapse all body getters above into a BodyInfo struct.
 
 	OcclusionQueryHandle createOcclusionQuery()
@@ -150,6 +150,9 @@ namespace max
 #include <bimg/bimg.h>
 #include "shader.h"
 #include "vertexlayout.h"
+#include "ecs.h"
+#include "filemap.h"
+#include "jobs.h"
 #include "version.h"
 
 #if !defined(MAX_DEFAULT_WIDTH) && !defined(MAX_DEFAULT_HEIGHT)
@@ -2257,6 +2260,8 @@ namespace max
 			m_immutable   = _immutable;
 			m_cubeMap     = _cubeMap;
 			m_flags       = _flags;
+			m_asyncLoad   = kInvalidHandle;
+			m_loadState   = uint8_t(LoadState::Ready);
 		}
 
 		bool isRt() const
@@ -2300,6 +2305,8 @@ namespace max
 		bool     m_owned;
 		bool     m_immutable;
 		bool     m_cubeMap;
+		uint16_t m_asyncLoad; //!< Pending asynchronous load, or `kInvalidHandle`.
+		uint8_t  m_loadState;
 	};
 
 	struct FrameBufferRef
@@ -2330,6 +2337,14 @@ namespace max
 	};
 	typedef stl::vector<Primitive> PrimitiveArray;
 
+	/// Simplified index buffer of mesh group.
+	struct MeshLod
+	{
+		IndexBufferHandle m_ibh;
+		uint32_t m_numIndices;
+		float m_error; //!< Object space simplification error.
+	};
+
 	struct Group
 	{
 		Group()
@@ -2345,6 +2360,7 @@ namespace max
 			m_vertices = NULL;
 			m_numIndices = 0;
 			m_indices = NULL;
+			m_numLods = 0;
 			m_prims.clear();
 		}
 
@@ -2357,21 +2373,91 @@ namespace max
 		bx::Sphere m_sphere;
 		bx::Aabb   m_aabb;
 		bx::Obb    m_obb;
+		MeshLod    m_lods[MAX_CONFIG_MAX_MESH_LODS]; //!< LOD 1 and up, LOD 0 is `m_ibh`.
+		uint8_t    m_numLods;
 		PrimitiveArray m_prims;
 	};
 	typedef stl::vector<Group> GroupArray;
 
 	struct MeshRef
 	{
+		uint32_t      m_hash;
 		const Memory* m_data;
 		VertexLayout  m_layout;
 		GroupArray	  m_groups;
 		uint32_t	  m_refCount;
+		uint16_t      m_asyncLoad; //!< Pending asynchronous load, or `kInvalidHandle`.
+		uint8_t       m_loadState;
+		float         m_lodError[MAX_CONFIG_MAX_MESH_LODS]; //!< Largest error of all groups per LOD.
+		uint8_t       m_numLods;
+	};
+
+	BX_ERROR_RESULT(kErrorMeshTruncated, BX_MAKEFOURCC('M', 'E', 0, 1) );
+
+	/// Mesh parsed from chunk stream, with vertex and index data of each
+	/// group not yet passed to renderer.
+	struct MeshData
+	{
+		struct Buffers
+		{
+			const Memory* m_vertices;
+			const Memory* m_indices;
+			const Memory* m_lods[MAX_CONFIG_MAX_MESH_LODS];
+			uint16_t m_indexFlags;
+			uint16_t m_lodIndexFlags;
+		};
+
+		VertexLayout m_layout;
+		GroupArray m_groups;
+		stl::vector<Buffers> m_buffers;
+	};
+
+	/// Mesh or texture loaded on I/O thread. Result is written by I/O thread
+	/// before state is changed from `Loading`, everything else is owned by
+	/// API thread.
+	struct AsyncLoad
+	{
+		struct Type
+		{
+			enum Enum
+			{
+				Mesh,
+				Texture,
+
+				Count
+			};
+		};
+
+		struct State
+		{
+			enum Enum
+			{
+				Loading,
+				Loaded,
+				Failed,
+				Swap, //!< Placeholder texture is destroyed, texture is created next frame.
+
+				Count
+			};
+		};
+
+		bx::FilePath m_filePath;
+		MeshData m_mesh;
+		bimg::ImageContainer* m_image;
+		uint64_t m_flags;
+		uint32_t m_hash; //!< Hash of loaded file.
+		int32_t  m_state;
+		uint16_t m_handle;
+		uint8_t  m_type;
+		uint8_t  m_skip;
+		bool     m_ramcopy;
+		bool     m_cancelled;
 	};
 
 	struct EntityRef
 	{
-		bx::HandleHashMapT<MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY * 2> m_components;
+		uint32_t m_row;
+		uint16_t m_archetype;
 
 		bool m_destroyComponents;
 		uint16_t m_refCount;
@@ -2379,11 +2465,125 @@ namespace max
 
 	struct ComponentRef
 	{
-		void* m_data;
+		void* m_data; //!< Component data, NULL while component is stored in archetype.
 		uint32_t m_size;
+		ComponentTypeHandle m_type;
+		EntityHandle m_entity;
 		uint16_t m_refCount;
 	};
 
+	struct EntityCommandBufferImpl
+	{
+		/// Entities created through command buffer get temporary handles,
+		/// valid only within same command buffer until playback. Temporary
+		/// handle is tagged with index of command buffer that created it.
+		static const uint32_t kTempEntityBit    = UINT32_C(0x80000000);
+		static const uint32_t kTempBufferShift  = 24;
+		static const uint32_t kTempBufferMask   = UINT32_C(0x7f000000);
+		static const uint32_t kTempEntityMask   = UINT32_C(0x00ffffff);
+
+		struct Command
+		{
+			enum Enum : uint8_t
+			{
+				CreateEntity,
+				DestroyEntity,
+				AddComponent,
+				RemoveComponent,
+
+				Count
+			};
+		};
+
+		EntityCommandBufferImpl()
+			: m_buffer(NULL)
+			, m_size(0)
+			, m_pos(0)
+			, m_numEntities(0)
+			, m_idx(kInvalidHandle)
+			, m_ended(false)
+		{
+		}
+
+		void shutdown()
+		{
+			bx::free(g_allocator, m_buffer);
+			m_buffer = NULL;
+			m_size = 0;
+			reset();
+		}
+
+		void reset()
+		{
+			m_pos = 0;
+			m_numEntities = 0;
+			m_ended = false;
+		}
+
+		void write(const void* _data, uint32_t _size)
+		{
+			if (m_pos + _size > m_size)
+			{
+				m_size = bx::max<uint32_t>(m_pos + _size, bx::max<uint32_t>(m_size*2, 4<<10) );
+				m_buffer = (uint8_t*)bx::realloc(g_allocator, m_buffer, m_size);
+			}
+
+			bx::memCopy(&m_buffer[m_pos], _data, _size);
+			m_pos += _size;
+		}
+
+		template<typename Ty>
+		void write(const Ty& _in)
+		{
+			write(&_in, sizeof(Ty) );
+		}
+
+		EntityHandle createEntity(bool _destroyComponents)
+		{
+			BX_ASSERT(m_numEntities <= kTempEntityMask, "Too many entities created by single command buffer.");
+			EntityHandle handle = { kTempEntityBit | (uint32_t(m_idx) << kTempBufferShift) | m_numEntities };
+
+			write(Command::CreateEntity);
+			write(m_numEntities);
+			write(_destroyComponents);
+
+			++m_numEntities;
+
+			return handle;
+		}
+
+		void destroy(EntityHandle _entity)
+		{
+			write(Command::DestroyEntity);
+			write(_entity);
+		}
+
+		void addComponent(EntityHandle _entity, ComponentTypeHandle _type, const void* _data, uint32_t _size)
+		{
+			write(Command::AddComponent);
+			write(_entity);
+			write(_type);
+			write(_size);
+			write(_data, _size);
+		}
+
+		void removeComponent(EntityHandle _entity, ComponentTypeHandle _type)
+		{
+			write(Command::RemoveComponent);
+			write(_entity);
+			write(_type);
+		}
+
+		uint8_t* m_buffer;
+		uint32_t m_size;
+		uint32_t m_pos;
+		uint32_t m_numEntities;
+		uint16_t m_idx;
+		bool     m_ended;
+	};
+
+	BX_STATIC_ASSERT(MAX_CONFIG_MAX_ENTITY_COMMAND_BUFFERS <= (EntityCommandBufferImpl::kTempBufferMask >> EntityCommandBufferImpl::kTempBufferShift) + 1);
+
 	BX_ALIGN_DECL_CACHE_LINE(struct) View
 	{
 		void reset()
@@ -2663,16 +2863,6 @@ namespace max
 			return m_freeMesh.queue(_handle);
 		}
 
-		bool free(ComponentHandle _handle)
-		{
-			return m_freeComponent.queue(_handle);
-		}
-
-		bool free(EntityHandle _handle)
-		{
-			return m_freeEntity.queue(_handle);
-		}
-
 		void resetFreeHandles()
 		{
 			m_freeIndexBuffer.reset();
@@ -2684,8 +2874,6 @@ namespace max
 			m_freeFrameBuffer.reset();
 			m_freeUniform.reset();
 			m_freeMesh.reset();
-			m_freeComponent.reset();
-			m_freeEntity.reset();
 		}
 
 		ViewId m_viewRemap[MAX_CONFIG_MAX_VIEWS];
@@ -2788,8 +2976,6 @@ namespace max
 		FreeHandle<FrameBufferHandle,  MAX_CONFIG_MAX_FRAME_BUFFERS>  m_freeFrameBuffer;
 		FreeHandle<UniformHandle,      MAX_CONFIG_MAX_UNIFORMS>       m_freeUniform;
 		FreeHandle<MeshHandle,		   MAX_CONFIG_MAX_MESHES>         m_freeMesh;
-		FreeHandle<ComponentHandle,	   MAX_CONFIG_MAX_COMPONENTS>     m_freeComponent;
-		FreeHandle<EntityHandle,	   MAX_CONFIG_MAX_ENTITIES>       m_freeEntity;
 
 		TextVideoMem* m_textVideoMem;
 
@@ -3295,6 +3481,10 @@ namespace max
 		static max::VertexLayout ms_layout;
 	};
 
+	/// Submit line list with single draw call, `_num` is number of vertices
+	/// (two per line). Lines not fitting into transient buffer are dropped.
+	void dbgDrawLineList(ViewId _viewId, const DebugPosVertex* _vertices, uint32_t _num);
+
 	struct DebugUvVertex
 	{
 		float m_x;
@@ -4822,13 +5012,27 @@ namespace max
 
 	void rendererUpdateUniforms(RendererContextI* _renderCtx, UniformBuffer* _uniformBuffer, uint32_t _begin, uint32_t _end);
 
+	/// Body transform snapshot published by physics thread.
+	struct BodyTransform
+	{
+		float m_pos[3];
+		float m_rot[4];
+	};
+
 	struct BX_NO_VTABLE PhysicsContextI
 	{
 		virtual ~PhysicsContextI() = 0;
 		virtual PhysicsType::Enum getPhysicsType() const = 0;
 		virtual const char* getPhysicsName() const = 0;
-		virtual void simulate(const float _dt) = 0;
+		virtual void simulate(const float _dt, uint32_t _collisionSteps) = 0;
+		virtual void getBodyTransforms(BodyTransform* _transforms) = 0;
+		virtual void debugDraw(ViewId _viewId) = 0;
+		virtual void publishEvents() = 0;
+		virtual void getStats(PhysicsStats& _stats) = 0;
+		virtual const ContactEvent* getContactEvents(uint32_t* _num) = 0;
+		virtual const ActivationEvent* getActivationEvents(uint32_t* _num) = 0;
 		virtual void createBody(BodyHandle _handle, CollisionShape::Enum _shape, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags) = 0;
+		virtual bool createMeshBody(BodyHandle _handle, CollisionShape::Enum _shape, const MeshRef& _mesh, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags) = 0;
 		virtual void destroyBody(BodyHandle _handle) = 0;
 		virtual void setPosition(BodyHandle _handle, const bx::Vec3& _pos, Activation::Enum _activation) = 0;
 		virtual bx::Vec3 getPosition(BodyHandle _handle) = 0;
@@ -4845,10 +5049,19 @@ namespace max
 		virtual void addForce(BodyHandle _handle, const bx::Vec3& _force, Activation::Enum _activation) = 0;
 		virtual void addTorque(BodyHandle _handle, const bx::Vec3& _torque, Activation::Enum _activation) = 0;
 		virtual void addMovement(BodyHandle _handle, const bx::Vec3& _position, const bx::Quaternion& _rotation, const float _deltaTime) = 0;
+		virtual void getTransforms(const BodyHandle* _handles, uint32_t _num, bx::Vec3* _positions, bx::Quaternion* _rotations) = 0;
+		virtual void setPositions(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _positions, Activation::Enum _activation) = 0;
+		virtual void addForces(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _forces, Activation::Enum _activation) = 0;
+		virtual uint32_t getActiveBodies(BodyHandle* _handles, uint32_t _max) = 0;
+		virtual void rayCast(const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits) = 0;
+		virtual void shapeCast(CollisionShape::Enum _shape, const bx::Vec3& _scale, const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits) = 0;
+		virtual void overlap(CollisionShape::Enum _shape, const bx::Vec3& _scale, const bx::Vec3* _positions, uint32_t _num, BodyHandle* _bodies, uint32_t _maxBodies, uint32_t* _numBodies) = 0;
 		virtual void setFriction(BodyHandle _handle, float _friction) = 0;
 		virtual float getFriction(BodyHandle _handle) = 0;
 		virtual void getGroundInfo(BodyHandle _handle, GroundInfo& _info) = 0;
 		virtual const bx::Vec3 getGravity() = 0;
+		virtual uint32_t saveState(void* _data, uint32_t _size, PhysicsState::Enum _state) = 0;
+		virtual bool restoreState(const void* _data, uint32_t _size) = 0;
 	};
 
 	inline PhysicsContextI::~PhysicsContextI()
@@ -5041,6 +5254,10 @@ namespace max
 			, m_numFreeDynamicVertexBufferHandles(0)
 			, m_numFreeBodyHandles(0)
 			, m_numFreeOcclusionQueryHandles(0)
+			, m_numArchetypes(0)
+			, m_numEntityQueries(0)
+			, m_numParallelEach(0)
+			, m_numEntityCommandsQueued(0)
 			, m_colorPaletteDirty(0)
 			, m_frames(0)
 			, m_debug(MAX_DEBUG_NONE)
@@ -5048,6 +5265,14 @@ namespace max
 			, m_textureMemoryUsed(0)
 			, m_renderCtx(NULL)
 			, m_physicsCtx(NULL)
+			, m_physicsRead(0)
+			, m_physicsStep(0.0f)
+			, m_physicsAccumulator(0.0f)
+			, m_physicsNumSteps(0)
+			, m_physicsMaxSubsteps(0)
+			, m_physicsCollisionSteps(0)
+			, m_physicsPending(false)
+			, m_physicsExit(false)
 			, m_headless(false)
 			, m_rendererInitialized(false)
 			, m_exit(false)
@@ -5227,6 +5452,22 @@ namespace max
 			stats.textureMemoryUsed = m_textureMemoryUsed;
 			stats.rtMemoryUsed      = m_rtMemoryUsed;
 
+			if (NULL != m_physicsCtx)
+			{
+				m_physicsCtx->getStats(stats.physics);
+			}
+			else
+			{
+				bx::memSet(&stats.physics, 0, sizeof(stats.physics) );
+			}
+
+			stats.ecs.numEntities       = m_entityHandle.getNumHandles();
+			stats.ecs.numComponents     = m_componentHandle.getNumHandles();
+			stats.ecs.numArchetypes     = m_numArchetypes;
+			stats.ecs.queryMemoryUsed   = m_queryArena.getUsed();
+			stats.ecs.queryMemoryMax    = m_queryArena.getSize();
+			stats.ecs.numQueryOverflows = m_queryArena.getNumOverflows();
+
 			return &stats;
 		}
 
@@ -6564,19 +6805,37 @@ namespace max
 				return MAX_INVALID_HANDLE;
 			}
 
-			TextureRef& ref = m_textureRef[handle.idx];
+			textureCreate(handle, imageContainer, *_info, _mem, _flags, _skip, _ratio, _immutable);
+
+			setDebugNameForHandle(handle);
+
+			return handle;
+		}
+
+		void textureCreate(
+			  TextureHandle _handle
+			, const bimg::ImageContainer& _imageContainer
+			, const TextureInfo& _info
+			, const Memory* _mem
+			, uint64_t _flags
+			, uint8_t _skip
+			, BackbufferRatio::Enum _ratio
+			, bool _immutable
+			)
+		{
+			TextureRef& ref = m_textureRef[_handle.idx];
 			ref.init(
 				  _ratio
-				, uint16_t(imageContainer.m_width)
-				, uint16_t(imageContainer.m_height)
-				, uint16_t(imageContainer.m_depth)
-				, _info->format
-				, _info->storageSize
-				, imageContainer.m_numMips
-				, imageContainer.m_numLayers
+				, uint16_t(_imageContainer.m_width)
+				, uint16_t(_imageContainer.m_height)
+				, uint16_t(_imageContainer.m_depth)
+				, _info.format
+				, _info.storageSize
+				, _imageContainer.m_numMips
+				, _imageContainer.m_numLayers
 				, 0 != (g_caps.supported & MAX_CAPS_TEXTURE_DIRECT_ACCESS)
 				, _immutable
-				, imageContainer.m_cubeMap
+				, _imageContainer.m_cubeMap
 				, _flags
 				);
 
@@ -6590,14 +6849,51 @@ namespace max
 			}
 
 			CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::CreateTexture);
-			cmdbuf.write(handle);
+			cmdbuf.write(_handle);
 			cmdbuf.write(_mem);
 			cmdbuf.write(_flags);
 			cmdbuf.write(_skip);
+		}
 
-			setDebugNameForHandle(handle);
+		/// Create texture with existing handle, texture previously created
+		/// with handle must be destroyed in earlier frame. References and name
+		/// are kept.
+		void textureReplace(TextureHandle _handle, const Memory* _mem, uint64_t _flags, uint8_t _skip)
+		{
+			bimg::ImageContainer imageContainer;
+			const bool ok = bimg::imageParse(imageContainer, _mem->data, _mem->size);
+			BX_ASSERT(ok, "Failed to parse texture."); BX_UNUSED(ok);
+
+			TextureInfo info;
+			calcTextureSize(info
+				, (uint16_t)imageContainer.m_width
+				, (uint16_t)imageContainer.m_height
+				, (uint16_t)imageContainer.m_depth
+				, imageContainer.m_cubeMap
+				, imageContainer.m_numMips > 1
+				, imageContainer.m_numLayers
+				, TextureFormat::Enum(imageContainer.m_format)
+				);
 
-			return handle;
+			_flags |= imageContainer.m_srgb ? MAX_TEXTURE_SRGB : 0;
+
+			TextureRef& ref = m_textureRef[_handle.idx];
+			const int16_t refCount = ref.m_refCount;
+			const bool owned = ref.m_owned;
+
+			if (ref.isRt() )
+			{
+				m_rtMemoryUsed -= int64_t(ref.m_storageSize);
+			}
+			else
+			{
+				m_textureMemoryUsed -= int64_t(ref.m_storageSize);
+			}
+
+			textureCreate(_handle, imageContainer, info, _mem, _flags, _skip, BackbufferRatio::Count, true);
+
+			ref.m_refCount = refCount;
+			ref.m_owned    = owned;
 		}
 
 		MAX_API_FUNC(void setName(TextureHandle _handle, const bx::StringView& _name) )
@@ -6706,6 +7002,14 @@ namespace max
 			{
 				ref.m_name.clear();
 
+				// Placeholder of texture being swapped is already destroyed.
+				bool destroy = true;
+				if (kInvalidHandle != ref.m_asyncLoad)
+				{
+					destroy = AsyncLoad::State::Swap != asyncLoadCancel(ref.m_asyncLoad);
+					ref.m_asyncLoad = kInvalidHandle;
+				}
+
 				if (ref.isRt() )
 				{
 					m_rtMemoryUsed -= int64_t(ref.m_storageSize);
@@ -6718,8 +7022,11 @@ namespace max
 				bool ok = m_submit->free(_handle); BX_UNUSED(ok);
 				BX_ASSERT(ok, "Texture handle %d is already destroyed!", _handle.idx);
 
-				CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyTexture);
-				cmdbuf.write(_handle);
+				if (destroy)
+				{
+					CommandBuffer& cmdbuf = getCommandBuffer(CommandBuffer::DestroyTexture);
+					cmdbuf.write(_handle);
+				}
 			}
 		}
 
@@ -7038,6 +7345,12 @@ namespace max
 				bool ok = m_submit->free(_handle); BX_UNUSED(ok);
 				BX_ASSERT(ok, "Mesh handle %d is already destroyed!", _handle.idx);
 
+				if (kInvalidHandle != mr.m_asyncLoad)
+				{
+					asyncLoadCancel(mr.m_asyncLoad);
+					mr.m_asyncLoad = kInvalidHandle;
+				}
+
 				for (GroupArray::const_iterator it = mr.m_groups.begin(), itEnd = mr.m_groups.end(); it != itEnd; ++it)
 				{
 					const Group& group = *it;
@@ -7049,6 +7362,11 @@ namespace max
 						destroyIndexBuffer(group.m_ibh);
 					}
 
+					for (uint32_t ii = 0; ii < group.m_numLods; ++ii)
+					{
+						destroyIndexBuffer(group.m_lods[ii].m_ibh);
+					}
+
 					if (NULL != group.m_vertices)
 					{
 						bx::free(g_allocator, group.m_vertices);
@@ -7065,12 +7383,60 @@ namespace max
 			}
 		}
 
-		// @todo Rewrite mesh compiler to use uint32_t for indices instead of uint16_t.
-		MAX_API_FUNC(MeshHandle createMesh(const Memory* _mem, bool _ramcopy))
+		static uint32_t readVertexCount(bx::ReaderI* _reader, bool _count16, bx::Error* _err)
 		{
-			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			if (_count16)
+			{
+				uint16_t numVertices = 0;
+				bx::read(_reader, numVertices, _err);
+				return numVertices;
+			}
 
-			bx::MemoryReader reader(_mem->data, _mem->size);
+			uint32_t numVertices = 0;
+			bx::read(_reader, numVertices, _err);
+			return numVertices;
+		}
+
+		/// Returns copy of 16-bit or 32-bit index buffer as 32-bit indices.
+		static uint32_t* copyIndices(const void* _indices, uint32_t _numIndices, bool _index32)
+		{
+			uint32_t* indices = (uint32_t*)bx::alloc(g_allocator, _numIndices * sizeof(uint32_t) );
+
+			if (_index32)
+			{
+				bx::memCopy(indices, _indices, _numIndices * sizeof(uint32_t) );
+				return indices;
+			}
+
+			const uint16_t* src = (const uint16_t*)_indices;
+			for (uint32_t ii = 0; ii < _numIndices; ++ii)
+			{
+				indices[ii] = src[ii];
+			}
+
+			return indices;
+		}
+
+		/// Returns vertex or index data of uncompressed chunk. Data of mapped
+		/// file is referenced directly, otherwise it's copied.
+		static const Memory* readChunkData(bx::MemoryReader* _reader, uint32_t _size, FileMap* _map, bx::Error* _err)
+		{
+			if (NULL != _map
+			&&  _size <= _reader->remaining() )
+			{
+				const uint8_t* data = _reader->getDataPtr();
+				bx::skip(_reader, _size);
+				return _map->makeRef(data, _size);
+			}
+
+			const Memory* mem = alloc(_size);
+			bx::read(_reader, mem->data, _size, _err);
+			return mem;
+		}
+
+		MAX_API_FUNC(MeshHandle createMesh(const Memory* _mem, bool _ramcopy, FileMap* _map = NULL))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
 
 			const uint32_t meshHash = bx::hash<bx::HashMurmur2A>(_mem->data, _mem->size);
 			const uint16_t idx = m_meshHashMap.find(meshHash);
@@ -7094,16 +7460,95 @@ namespace max
 			BX_ASSERT(ok, "Mesh already exists!"); BX_UNUSED(ok);
 
 			MeshRef& mr = m_meshRef[handle.idx];
+			mr.m_hash = meshHash;
 			mr.m_refCount = 1;
 			mr.m_data = _mem;
+			mr.m_asyncLoad = kInvalidHandle;
+			mr.m_loadState = uint8_t(LoadState::Ready);
+
+			MeshData data;
+			meshParse(data, _mem, _ramcopy, _map, &m_jobPool);
+			meshCreate(mr, data);
+
+			return handle;
+		}
+
+		/// Compressed vertex or index chunk, decoded after whole chunk stream
+		/// is indexed.
+		struct MeshDecode
+		{
+			const uint8_t* m_src;
+			uint32_t m_srcSize;
+			const Memory* m_dst;
+			uint32_t m_num;
+			uint32_t m_group;
+			uint16_t m_size; //!< Vertex stride or index size.
+			bool m_index;
+		};
+
+		struct MeshDecodeJob
+		{
+			MeshData* m_data;
+			const MeshDecode* m_decodes;
+			bool m_ramcopy;
+		};
+
+		static void meshDecodeRange(uint32_t _begin, uint32_t _end, void* _userData)
+		{
+			const MeshDecodeJob& job = *(const MeshDecodeJob*)_userData;
+
+			for (uint32_t ii = _begin; ii < _end; ++ii)
+			{
+				const MeshDecode& decode = job.m_decodes[ii];
+				Group& group = job.m_data->m_groups[decode.m_group];
+
+				if (decode.m_index)
+				{
+					meshopt_decodeIndexBuffer(decode.m_dst->data, decode.m_num, decode.m_size, decode.m_src, decode.m_srcSize);
+
+					if (job.m_ramcopy)
+					{
+						group.m_indices = copyIndices(decode.m_dst->data, decode.m_num, 4 == decode.m_size);
+					}
+				}
+				else
+				{
+					meshopt_decodeVertexBuffer(decode.m_dst->data, decode.m_num, decode.m_size, decode.m_src, decode.m_srcSize);
+
+					if (job.m_ramcopy)
+					{
+						group.m_vertices = (uint8_t*)bx::alloc(g_allocator, decode.m_dst->size);
+						bx::memCopy(group.m_vertices, decode.m_dst->data, decode.m_dst->size);
+					}
+				}
+			}
+		}
 
-			constexpr uint32_t kChunkVertexBuffer = BX_MAKEFOURCC('V', 'B', ' ', 0x1);
-			constexpr uint32_t kChunkVertexBufferCompressed = BX_MAKEFOURCC('V', 'B', 'C', 0x0);
+		/// Parse mesh chunk stream and release `_mem`. Doesn't touch context
+		/// and can be called from any thread. Compressed chunks of all groups
+		/// are decoded in parallel on `_jobPool` when it's not NULL. Returns
+		/// false if stream has no groups.
+		static bool meshParse(MeshData& _data, const Memory* _mem, bool _ramcopy, FileMap* _map, JobPool* _jobPool)
+		{
+			bx::MemoryReader reader(_mem->data, _mem->size);
+			stl::vector<MeshDecode> decodes;
+
+			// Vertex buffer chunks before version 2 (compressed 1) have 16-bit
+			// vertex count. Index buffer chunk version selects index size.
+			constexpr uint32_t kChunkVertexBuffer16 = BX_MAKEFOURCC('V', 'B', ' ', 0x1);
+			constexpr uint32_t kChunkVertexBuffer = BX_MAKEFOURCC('V', 'B', ' ', 0x2);
+			constexpr uint32_t kChunkVertexBufferCompressed16 = BX_MAKEFOURCC('V', 'B', 'C', 0x0);
+			constexpr uint32_t kChunkVertexBufferCompressed = BX_MAKEFOURCC('V', 'B', 'C', 0x1);
 			constexpr uint32_t kChunkIndexBuffer = BX_MAKEFOURCC('I', 'B', ' ', 0x0);
+			constexpr uint32_t kChunkIndexBuffer32 = BX_MAKEFOURCC('I', 'B', ' ', 0x1);
 			constexpr uint32_t kChunkIndexBufferCompressed = BX_MAKEFOURCC('I', 'B', 'C', 0x1);
+			constexpr uint32_t kChunkIndexBufferCompressed32 = BX_MAKEFOURCC('I', 'B', 'C', 0x2);
 			constexpr uint32_t kChunkPrimitive = BX_MAKEFOURCC('P', 'R', 'I', 0x0);
+			constexpr uint32_t kChunkLod = BX_MAKEFOURCC('L', 'O', 'D', 0x0);
 
 			Group group;
+			MeshData::Buffers buffers;
+			bx::memSet(&buffers, 0, sizeof(buffers) );
 
 			uint32_t chunk;
 			bx::Error err;
@@ -7111,21 +7556,19 @@ namespace max
 			{
 				switch (chunk)
 				{
+				case kChunkVertexBuffer16:
 				case kChunkVertexBuffer:
 				{
 					bx::read(&reader, group.m_sphere, &err);
 					bx::read(&reader, group.m_aabb, &err);
 					bx::read(&reader, group.m_obb, &err);
-					read(&reader, mr.m_layout, &err);
+					read(&reader, _data.m_layout, &err);
 
-					uint16_t stride = mr.m_layout.getStride();
+					uint16_t stride = _data.m_layout.getStride();
 
-					uint16_t numVertices = 0;
-					bx::read(&reader, numVertices, &err);
-					group.m_numVertices = (uint32_t)numVertices;
+					group.m_numVertices = readVertexCount(&reader, kChunkVertexBuffer16 == chunk, &err);
 
-					const Memory* mem = alloc(group.m_numVertices * stride);
-					bx::read(&reader, mem->data, mem->size, &err);
+					const Memory* mem = readChunkData(&reader, group.m_numVertices * stride, _map, &err);
 
 					if (_ramcopy)
 					{
@@ -7133,95 +7576,97 @@ namespace max
 						bx::memCopy(group.m_vertices, mem->data, mem->size);
 					}
 
-					group.m_vbh = createVertexBuffer(mem, mr.m_layout, MAX_BUFFER_NONE);
+					buffers.m_vertices = mem;
 				}
 				break;
 
+				case kChunkVertexBufferCompressed16:
 				case kChunkVertexBufferCompressed:
 				{
 					bx::read(&reader, group.m_sphere, &err);
 					bx::read(&reader, group.m_aabb, &err);
 					bx::read(&reader, group.m_obb, &err);
 
-					read(&reader, mr.m_layout, &err);
-
-					uint16_t stride = mr.m_layout.getStride();
+					read(&reader, _data.m_layout, &err);
 
-					uint16_t numVertices = 0;
-					bx::read(&reader, numVertices, &err);
-					group.m_numVertices = (uint32_t)numVertices;
+					uint16_t stride = _data.m_layout.getStride();
 
-					const Memory* mem = alloc(group.m_numVertices * stride);
+					group.m_numVertices = readVertexCount(&reader, kChunkVertexBufferCompressed16 == chunk, &err);
 
 					uint32_t compressedSize;
 					bx::read(&reader, compressedSize, &err);
 
-					void* compressedVertices = bx::alloc(g_allocator, compressedSize);
-					bx::read(&reader, compressedVertices, compressedSize, &err);
-
-					meshopt_decodeVertexBuffer(mem->data, group.m_numVertices, stride, (uint8_t*)compressedVertices, compressedSize);
-
-					bx::free(g_allocator, compressedVertices);
-
-					if (_ramcopy)
+					if (compressedSize > reader.remaining() )
 					{
-						group.m_vertices = (uint8_t*)bx::alloc(g_allocator, group.m_numVertices * stride);
-						bx::memCopy(group.m_vertices, mem->data, mem->size);
+						err.setError(kErrorMeshTruncated, "Compressed vertex buffer is truncated.");
+						break;
 					}
 
-					group.m_vbh = createVertexBuffer(mem, mr.m_layout, MAX_BUFFER_NONE);
+					MeshDecode decode;
+					decode.m_src     = reader.getDataPtr();
+					decode.m_srcSize = compressedSize;
+					decode.m_dst     = alloc(group.m_numVertices * stride);
+					decode.m_num     = group.m_numVertices;
+					decode.m_group   = uint32_t(_data.m_groups.size() );
+					decode.m_size    = stride;
+					decode.m_index   = false;
+					decodes.push_back(decode);
+
+					bx::skip(&reader, compressedSize);
+
+					buffers.m_vertices = decode.m_dst;
 				}
 				break;
 
 				case kChunkIndexBuffer:
+				case kChunkIndexBuffer32:
 				{
+					const bool index32 = kChunkIndexBuffer32 == chunk;
+
 					bx::read(&reader, group.m_numIndices, &err);
 
-					const Memory* mem = alloc(group.m_numIndices * 2);
-					bx::read(&reader, mem->data, mem->size, &err);
+					const Memory* mem = readChunkData(&reader, group.m_numIndices * (index32 ? 4 : 2), _map, &err);
 
 					if (_ramcopy)
 					{
-						group.m_indices = (uint32_t*)bx::alloc(g_allocator, group.m_numIndices * sizeof(uint32_t));
-						const uint16_t* src = (const uint16_t*)mem->data;
-						for (uint32_t i = 0; i < group.m_numIndices; ++i)
-						{
-							group.m_indices[i] = (uint32_t)src[i];
-						}
+						group.m_indices = copyIndices(mem->data, group.m_numIndices, index32);
 					}
 
-					group.m_ibh = createIndexBuffer(mem, MAX_BUFFER_NONE);
+					buffers.m_indices = mem;
+					buffers.m_indexFlags = index32 ? MAX_BUFFER_INDEX32 : MAX_BUFFER_NONE;
 				}
 				break;
 
 				case kChunkIndexBufferCompressed:
+				case kChunkIndexBufferCompressed32:
 				{
-					bx::read(&reader, group.m_numIndices, &err);
+					const bool index32 = kChunkIndexBufferCompressed32 == chunk;
 
-					const Memory* mem = alloc(group.m_numIndices * 2);
+					bx::read(&reader, group.m_numIndices, &err);
 
 					uint32_t compressedSize;
 					bx::read(&reader, compressedSize, &err);
 
-					void* compressedIndices = bx::alloc(g_allocator, compressedSize);
-
-					bx::read(&reader, compressedIndices, compressedSize, &err);
-
-					meshopt_decodeIndexBuffer(mem->data, group.m_numIndices, 2, (uint8_t*)compressedIndices, compressedSize);
-
-					bx::free(g_allocator, compressedIndices);
-
-					if (_ramcopy)
+					if (compressedSize > reader.remaining() )
 					{
-						group.m_indices = (uint32_t*)bx::alloc(g_allocator, group.m_numIndices * sizeof(uint32_t));
-						const uint16_t* src = (const uint16_t*)mem->data;
-						for (uint32_t i = 0; i < group.m_numIndices; ++i)
-						{
-							group.m_indices[i] = (uint32_t)src[i];
-						}
+						err.setError(kErrorMeshTruncated, "Compressed index buffer is truncated.");
+						break;
 					}
 
-					group.m_ibh = createIndexBuffer(mem, MAX_BUFFER_NONE);
+					MeshDecode decode;
+					decode.m_src     = reader.getDataPtr();
+					decode.m_srcSize = compressedSize;
+					decode.m_dst     = alloc(group.m_numIndices * (index32 ? 4 : 2) );
+					decode.m_num     = group.m_numIndices;
+					decode.m_group   = uint32_t(_data.m_groups.size() );
+					decode.m_size    = index32 ? 4 : 2;
+					decode.m_index   = true;
+					decodes.push_back(decode);
+
+					bx::skip(&reader, compressedSize);
+
+					buffers.m_indices = decode.m_dst;
+					buffers.m_indexFlags = index32 ? MAX_BUFFER_INDEX32 : MAX_BUFFER_NONE;
 				}
 				break;
 
@@ -7257,24 +7702,219 @@ namespace max
 						group.m_prims.push_back(prim);
 					}
 
-					mr.m_groups.push_back(group);
+					_data.m_groups.push_back(group);
+					_data.m_buffers.push_back(buffers);
 					group.reset();
+					bx::memSet(&buffers, 0, sizeof(buffers) );
 				}
 				break;
 
-				default:
-					BX_TRACE("%08x at %d", chunk, bx::skip(&reader, 0));
-					break;
-				}
-			}
+				case kChunkLod:
+				{
+					uint8_t numLods;
+					bx::read(&reader, numLods, &err);
 
-			release(_mem);
-			return handle;
-		}
+					uint8_t indexSize;
+					bx::read(&reader, indexSize, &err);
 
-		MAX_API_FUNC(MeshHandle createMesh(const Memory* _vertices, const Memory* _indices, const VertexLayout& _layout))
-		{
-			MAX_MUTEX_SCOPE(m_resourceApiLock);
+					buffers.m_lodIndexFlags = 4 == indexSize ? MAX_BUFFER_INDEX32 : MAX_BUFFER_NONE;
+
+					for (uint32_t ii = 0; ii < numLods; ++ii)
+					{
+						float error;
+						bx::read(&reader, error, &err);
+
+						uint32_t numIndices;
+						bx::read(&reader, numIndices, &err);
+
+						const Memory* mem = readChunkData(&reader, numIndices * indexSize, _map, &err);
+
+						if (group.m_numLods < MAX_CONFIG_MAX_MESH_LODS)
+						{
+							MeshLod& lod = group.m_lods[group.m_numLods];
+							lod.m_ibh.idx = kInvalidHandle;
+							lod.m_numIndices = numIndices;
+							lod.m_error = error;
+							buffers.m_lods[group.m_numLods++] = mem;
+						}
+						else
+						{
+							release(mem);
+						}
+					}
+				}
+				break;
+
+				default:
+					BX_TRACE("%08x at %d", chunk, bx::skip(&reader, 0));
+					break;
+				}
+			}
+
+			BX_WARN(err != kErrorMeshTruncated, "Mesh chunk stream is truncated.");
+
+			// Chunks of group without primitive chunk are dropped.
+			const uint32_t numGroups = uint32_t(_data.m_groups.size() );
+			while (!decodes.empty()
+			&&     decodes.back().m_group >= numGroups)
+			{
+				decodes.pop_back();
+			}
+
+			if (NULL != buffers.m_vertices)
+			{
+				release(buffers.m_vertices);
+			}
+
+			if (NULL != buffers.m_indices)
+			{
+				release(buffers.m_indices);
+			}
+
+			for (uint32_t ii = 0; ii < group.m_numLods; ++ii)
+			{
+				release(buffers.m_lods[ii]);
+			}
+
+			if (NULL != group.m_vertices)
+			{
+				bx::free(g_allocator, group.m_vertices);
+			}
+
+			if (NULL != group.m_indices)
+			{
+				bx::free(g_allocator, group.m_indices);
+			}
+
+			// Groups are independent, decode all of them at once. Compressed
+			// data is read straight from `_mem`, which is released after join.
+			if (!decodes.empty() )
+			{
+				MeshDecodeJob job;
+				job.m_data     = &_data;
+				job.m_decodes  = decodes.data();
+				job.m_ramcopy  = _ramcopy;
+
+				const uint32_t num = uint32_t(decodes.size() );
+				if (NULL != _jobPool)
+				{
+					_jobPool->parallelFor(num, 1, num, meshDecodeRange, &job);
+				}
+				else
+				{
+					meshDecodeRange(0, num, &job);
+				}
+			}
+
+			release(_mem);
+			return !_data.m_groups.empty();
+		}
+
+		/// Pass parsed group data to renderer and move groups into mesh.
+		/// Returns number of bytes uploaded.
+		uint32_t meshCreate(MeshRef& _mr, MeshData& _data)
+		{
+			uint32_t size = 0;
+
+			_mr.m_layout = _data.m_layout;
+			_mr.m_numLods = 0;
+
+			for (uint32_t ii = 0, num = uint32_t(_data.m_groups.size() ); ii < num; ++ii)
+			{
+				Group& group = _data.m_groups[ii];
+				MeshData::Buffers& buffers = _data.m_buffers[ii];
+
+				if (NULL != buffers.m_vertices)
+				{
+					size += buffers.m_vertices->size;
+					group.m_vbh = createVertexBuffer(buffers.m_vertices, _data.m_layout, MAX_BUFFER_NONE);
+				}
+
+				if (NULL != buffers.m_indices)
+				{
+					size += buffers.m_indices->size;
+					group.m_ibh = createIndexBuffer(buffers.m_indices, buffers.m_indexFlags);
+				}
+
+				for (uint32_t jj = 0; jj < group.m_numLods; ++jj)
+				{
+					size += buffers.m_lods[jj]->size;
+					group.m_lods[jj].m_ibh = createIndexBuffer(buffers.m_lods[jj], buffers.m_lodIndexFlags);
+				}
+
+				_mr.m_groups.push_back(group);
+			}
+
+			// Mesh LOD error is largest error of all groups, groups with fewer
+			// LODs keep using their last one.
+			for (uint32_t ii = 0, num = uint32_t(_mr.m_groups.size() ); ii < num; ++ii)
+			{
+				_mr.m_numLods = bx::max(_mr.m_numLods, _mr.m_groups[ii].m_numLods);
+			}
+
+			for (uint32_t lod = 0; lod < _mr.m_numLods; ++lod)
+			{
+				float error = 0.0f;
+
+				for (uint32_t ii = 0, num = uint32_t(_mr.m_groups.size() ); ii < num; ++ii)
+				{
+					const Group& group = _mr.m_groups[ii];
+					if (0 != group.m_numLods)
+					{
+						error = bx::max(error, group.m_lods[bx::min<uint32_t>(lod, group.m_numLods - 1)].m_error);
+					}
+				}
+
+				_mr.m_lodError[lod] = error;
+			}
+
+			_data.m_groups.clear();
+			_data.m_buffers.clear();
+
+			return size;
+		}
+
+		/// Release parsed mesh data which was not passed to renderer.
+		static void meshDataRelease(MeshData& _data)
+		{
+			for (uint32_t ii = 0, num = uint32_t(_data.m_groups.size() ); ii < num; ++ii)
+			{
+				const Group& group = _data.m_groups[ii];
+				const MeshData::Buffers& buffers = _data.m_buffers[ii];
+
+				if (NULL != buffers.m_vertices)
+				{
+					release(buffers.m_vertices);
+				}
+
+				if (NULL != buffers.m_indices)
+				{
+					release(buffers.m_indices);
+				}
+
+				for (uint32_t jj = 0; jj < group.m_numLods; ++jj)
+				{
+					release(buffers.m_lods[jj]);
+				}
+
+				if (NULL != group.m_vertices)
+				{
+					bx::free(g_allocator, group.m_vertices);
+				}
+
+				if (NULL != group.m_indices)
+				{
+					bx::free(g_allocator, group.m_indices);
+				}
+			}
+
+			_data.m_groups.clear();
+			_data.m_buffers.clear();
+		}
+
+		MAX_API_FUNC(MeshHandle createMesh(const Memory* _vertices, const Memory* _indices, const VertexLayout& _layout))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
 
 			const uint32_t meshHash = bx::hash<bx::HashMurmur2A>(_vertices->data, _vertices->size);
 			const uint16_t idx = m_meshHashMap.find(meshHash);
@@ -7297,8 +7937,12 @@ namespace max
 			BX_ASSERT(ok, "Mesh already exists!"); BX_UNUSED(ok);
 
 			MeshRef& mr = m_meshRef[handle.idx];
+			mr.m_hash = meshHash;
 			mr.m_refCount = 1;
 			mr.m_layout = _layout;
+			mr.m_asyncLoad = kInvalidHandle;
+			mr.m_loadState = uint8_t(LoadState::Ready);
+			mr.m_numLods = 0;
 
 			uint16_t stride = _layout.getStride();
 
@@ -7323,7 +7967,7 @@ namespace max
 			return handle;
 		}
 
-		MAX_API_FUNC(MeshQuery* queryMesh(MeshHandle _handle))
+		MAX_API_FUNC(MeshQuery* queryMesh(MeshHandle _handle, uint8_t _lod))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
 
@@ -7342,14 +7986,18 @@ namespace max
 			{
 				Group& group = mr.m_groups[ii];
 
+				// Groups with fewer LODs use their last one. RAM copy only
+				// has full detail indices.
+				const uint32_t lod = bx::min<uint32_t>(_lod, group.m_numLods);
+
 				vb.push_back(group.m_vbh);
-				ib.push_back(group.m_ibh);
+				ib.push_back(0 == lod ? group.m_ibh : group.m_lods[lod - 1].m_ibh);
 
 				MeshQuery::Data groupData;
 				groupData.m_numVertices = group.m_numVertices;
-				groupData.m_numIndices = group.m_numIndices;
+				groupData.m_numIndices = 0 == lod ? group.m_numIndices : group.m_lods[lod - 1].m_numIndices;
 				groupData.m_vertices = group.m_vertices;
-				groupData.m_indices = group.m_indices;
+				groupData.m_indices = 0 == lod ? group.m_indices : NULL;
 				data.push_back(groupData);
 			}
 
@@ -7374,6 +8022,27 @@ namespace max
 			return &m_meshQuery;
 		}
 
+		MAX_API_FUNC(uint8_t getMeshLod(MeshHandle _handle, float _distance, float _projScale, float _threshold))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			MAX_CHECK_HANDLE("getMeshLod", m_meshHandle, _handle);
+
+			const MeshRef& mr = m_meshRef[_handle.idx];
+
+			// Projected error in pixels is error * projScale / distance.
+			const float maxError = _threshold * bx::max(_distance, 0.0f) / bx::max(_projScale, bx::kFloatSmallest);
+
+			uint8_t lod = 0;
+			while (lod < mr.m_numLods
+			&&     mr.m_lodError[lod] <= maxError)
+			{
+				++lod;
+			}
+
+			return lod;
+		}
+
 		MAX_API_FUNC(const max::VertexLayout getLayout(MeshHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
@@ -7399,6 +8068,93 @@ namespace max
 			meshDecRef(_handle);
 		}
 
+		MAX_API_FUNC(MeshHandle loadMeshAsync(const char* _filePath, bool _ramcopy) )
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			if (m_asyncLoadHandle.getNumHandles() == m_asyncLoadHandle.getMaxHandles() )
+			{
+				BX_TRACE("Too many asynchronous loads in flight.");
+				return MAX_INVALID_HANDLE;
+			}
+
+			MeshHandle handle = { m_meshHandle.alloc() };
+
+			if (!isValid(handle) )
+			{
+				BX_TRACE("Failed to allocate mesh handle.");
+				return MAX_INVALID_HANDLE;
+			}
+
+			// Mesh has no groups until loaded. Asynchronously loaded meshes
+			// are not shared by content hash, hash is set once load finishes.
+			MeshRef& mr = m_meshRef[handle.idx];
+			mr.m_hash = 0;
+			mr.m_refCount = 1;
+			mr.m_data = NULL;
+			mr.m_layout = VertexLayout();
+			mr.m_numLods = 0;
+			mr.m_loadState = uint8_t(LoadState::Pending);
+			mr.m_asyncLoad = asyncLoadDispatch(AsyncLoad::Type::Mesh, handle.idx, _filePath, 0, 0, _ramcopy);
+
+			return handle;
+		}
+
+		MAX_API_FUNC(TextureHandle loadTextureAsync(const char* _filePath, uint64_t _flags, uint8_t _skip) );
+
+		MAX_API_FUNC(LoadState::Enum getLoadState(MeshHandle _handle) )
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_CHECK_HANDLE("getLoadState", m_meshHandle, _handle);
+
+			return LoadState::Enum(m_meshRef[_handle.idx].m_loadState);
+		}
+
+		MAX_API_FUNC(LoadState::Enum getLoadState(TextureHandle _handle) )
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_CHECK_HANDLE("getLoadState", m_textureHandle, _handle);
+
+			return LoadState::Enum(m_textureRef[_handle.idx].m_loadState);
+		}
+
+		uint16_t asyncLoadDispatch(AsyncLoad::Type::Enum _type, uint16_t _handle, const char* _filePath, uint64_t _flags, uint8_t _skip, bool _ramcopy)
+		{
+			const uint16_t idx = m_asyncLoadHandle.alloc();
+
+			AsyncLoad& load = m_asyncLoads[idx];
+			load.m_filePath.set(_filePath);
+			load.m_image     = NULL;
+			load.m_flags     = _flags;
+			load.m_hash      = 0;
+			load.m_state     = AsyncLoad::State::Loading;
+			load.m_handle    = _handle;
+			load.m_type      = uint8_t(_type);
+			load.m_skip      = _skip;
+			load.m_ramcopy   = _ramcopy;
+			load.m_cancelled = false;
+
+			m_ioJobPool.dispatch(asyncLoadJob, &load);
+
+			return idx;
+		}
+
+		/// Detach load from its handle, result is discarded once I/O thread
+		/// is done with it. Returns load state at time of cancellation.
+		AsyncLoad::State::Enum asyncLoadCancel(uint16_t _idx)
+		{
+			AsyncLoad& load = m_asyncLoads[_idx];
+			load.m_cancelled = true;
+
+			return AsyncLoad::State::Enum(bx::atomicFetchAndAdd<int32_t>(&load.m_state, 0) );
+		}
+
+		static void asyncLoadJob(void* _userData);
+		static void asyncLoadRelease(AsyncLoad& _load);
+		void asyncLoadFinish(const AsyncLoad& _load, LoadState::Enum _state);
+		void asyncLoadUpdate();
+		void asyncLoadShutdown();
+
 		void componentTakeOwnership(ComponentHandle _handle)
 		{
 			componentDecRef(_handle);
@@ -7416,8 +8172,15 @@ namespace max
 			int32_t refs = --cr.m_refCount;
 			if (0 == refs)
 			{
-				bool ok = m_submit->free(_handle); BX_UNUSED(ok);
-				BX_ASSERT(ok, "Component handle %d is already destroyed!", _handle.idx);
+				// Components are never referenced by render thread, handle is
+				// held until next frame only so stale handles don't alias.
+				m_componentHandle.free(_handle.idx);
+
+				if (isValid(cr.m_entity) )
+				{
+					entityRemoveComponent(cr.m_entity, cr.m_type);
+					cr.m_entity.idx = kInvalidHandle32;
+				}
 
 				bx::free(g_allocator, cr.m_data);
 
@@ -7426,28 +8189,43 @@ namespace max
 			}
 		}
 
-		MAX_API_FUNC(ComponentHandle createComponent(void* _data, uint32_t _size))
+		ComponentHandle componentCreate(const void* _data, uint32_t _size)
 		{
-			MAX_MUTEX_SCOPE(m_resourceApiLock);
-
 			ComponentHandle handle = { m_componentHandle.alloc() };
 			if (isValid(handle))
 			{
+				m_componentRef.reserve(handle.idx + 1);
+
 				ComponentRef& cr = m_componentRef[handle.idx];
 				cr.m_refCount = 1;
 
-				cr.m_data = bx::alloc(g_allocator, _size);
+				cr.m_data = NULL;
 				cr.m_size = _size;
+				cr.m_type.idx = kInvalidHandle;
+				cr.m_entity.idx = kInvalidHandle32;
 
-				bx::memMove(cr.m_data, _data, _size);
+				if (NULL != _data)
+				{
+					cr.m_data = bx::alloc(g_allocator, _size);
+					bx::memMove(cr.m_data, _data, _size);
+				}
 			}
 
 			return handle;
 		}
 
+		MAX_API_FUNC(ComponentHandle createComponent(void* _data, uint32_t _size))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			entityCheckStructural("createComponent");
+
+			return componentCreate(_data, _size);
+		}
+
 		MAX_API_FUNC(void destroyComponent(ComponentHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			entityCheckStructural("destroyComponent");
 
 			MAX_CHECK_HANDLE("destroyComponent", m_componentHandle, _handle);
 
@@ -7460,149 +8238,1142 @@ namespace max
 			componentDecRef(_handle);
 		}
 
-		void entityTakeOwnership(EntityHandle _handle)
+		uint16_t findOrCreateArchetype(ArchetypeColumn* _columns, uint32_t _num)
 		{
-			entityDecRef(_handle);
+			archetypeSortColumns(_columns, _num);
+
+			ComponentMask mask;
+			mask.reset();
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				mask.set(_columns[ii].m_type);
+			}
+
+			// Key is hash of mask, on collision probe next key until matching
+			// archetype or free key is found.
+			uint32_t key = mask.getKey();
+
+			uint16_t idx = m_archetypeHashMap.find(key);
+			while (kInvalidHandle != idx
+			&&     !(m_archetypes[idx].m_mask == mask) )
+			{
+				idx = m_archetypeHashMap.find(++key);
+			}
+
+			if (kInvalidHandle != idx)
+			{
+				const Archetype& archetype = m_archetypes[idx];
+				for (uint32_t ii = 0; ii < _num; ++ii)
+				{
+					const uint32_t column = archetype.findColumn(_columns[ii].m_type);
+					if (archetype.m_columns[column].m_size != _columns[ii].m_size)
+					{
+						BX_WARN(false, "Component type %d size mismatch %d (archetype: %d)."
+							, _columns[ii].m_type.idx
+							, _columns[ii].m_size
+							, archetype.m_columns[column].m_size
+							);
+						return kInvalidHandle;
+					}
+				}
+
+				return idx;
+			}
+
+			if (m_numArchetypes >= MAX_CONFIG_MAX_ARCHETYPES)
+			{
+				BX_WARN(false, "Too many archetypes (max: %d).", MAX_CONFIG_MAX_ARCHETYPES);
+				return kInvalidHandle;
+			}
+
+			idx = m_numArchetypes++;
+			m_archetypes.reserve(m_numArchetypes);
+			BX_PLACEMENT_NEW(&m_archetypes[idx], Archetype);
+			m_archetypes[idx].create(_columns, _num, g_allocator);
+			m_archetypeHashMap.insert(key, idx);
+
+			for (uint16_t ii = 0; ii < m_numEntityQueries; ++ii)
+			{
+				ArchetypeQuery& query = m_entityQueryRef[ii];
+				if (query.matches(m_archetypes[idx]) )
+				{
+					query.add(idx);
+				}
+			}
+
+			return idx;
 		}
 
-		void entityIncRef(EntityHandle _handle)
+		bool componentCheckSize(ComponentTypeHandle _type, uint32_t _size)
 		{
-			EntityRef& er = m_entityRef[_handle.idx];
-			++er.m_refCount;
+			const uint32_t size = componentTypeGetSize(_type);
+			if (0 != size
+			&&  size != _size)
+			{
+				BX_WARN(false, "Component type %d size mismatch %d (registered: %d).", _type.idx, _size, size);
+				return false;
+			}
+
+			return true;
 		}
 
-		void entityDecRef(EntityHandle _handle)
+		const ArchetypeQuery& findOrCreateQuery(const ComponentTypeHandle* _types, uint32_t _num)
 		{
-			EntityRef& er = m_entityRef[_handle.idx];
-			int32_t refs = --er.m_refCount;
-			if (0 == refs)
+			ComponentMask mask;
+			mask.reset();
+			for (uint32_t ii = 0; ii < _num; ++ii)
 			{
-				bool ok = m_submit->free(_handle); BX_UNUSED(ok);
-				BX_ASSERT(ok, "Entity handle %d is already destroyed!", _handle.idx);
+				if (!isValid(_types[ii]) )
+				{
+					// Component type was never registered, nothing can match.
+					m_entityQueryTemp.create(mask, g_allocator);
+					return m_entityQueryTemp;
+				}
+
+				mask.set(_types[ii]);
+			}
+
+			// Same probing as archetype lookup.
+			uint32_t key = mask.getKey();
 
-				auto it = er.m_components.first();
-				while (er.m_destroyComponents)
+			uint16_t idx = m_entityQueryHashMap.find(key);
+			while (kInvalidHandle != idx
+			&&     !(m_entityQueryRef[idx].m_mask == mask) )
+			{
+				idx = m_entityQueryHashMap.find(++key);
+			}
+
+			if (kInvalidHandle != idx)
+			{
+				return m_entityQueryRef[idx];
+			}
+
+			ArchetypeQuery* query = &m_entityQueryTemp;
+			if (m_numEntityQueries < MAX_CONFIG_MAX_ENTITY_QUERIES)
+			{
+				idx = m_numEntityQueries++;
+				m_entityQueryHashMap.insert(key, idx);
+				m_entityQueryRef.reserve(m_numEntityQueries);
+				query = BX_PLACEMENT_NEW(&m_entityQueryRef[idx], ArchetypeQuery);
+			}
+			else
+			{
+				BX_WARN(false, "Too many cached entity queries (max: %d).", MAX_CONFIG_MAX_ENTITY_QUERIES);
+			}
+
+			query->create(mask, g_allocator);
+
+			for (uint16_t ii = 0; ii < m_numArchetypes; ++ii)
+			{
+				if (query->matches(m_archetypes[ii]) )
 				{
-					ComponentHandle handle = { it.handle };
+					query->add(ii);
+				}
+			}
+
+			return *query;
+		}
+
+		void entityMove(EntityHandle _handle, uint16_t _archetype)
+		{
+			EntityRef& er = m_entityRef[_handle.idx];
+
+			uint32_t row = UINT32_MAX;
+			if (kInvalidHandle != _archetype)
+			{
+				Archetype& dst = m_archetypes[_archetype];
+				row = dst.alloc(_handle);
 
-					if (!er.m_components.next(it))
+				if (kInvalidHandle != er.m_archetype)
+				{
+					const Archetype& src = m_archetypes[er.m_archetype];
+					for (uint32_t ii = 0; ii < src.m_numColumns; ++ii)
 					{
-						break;
+						const uint32_t column = dst.findColumn(src.m_columns[ii].m_type);
+						if (UINT32_MAX != column)
+						{
+							dst.getHandle(row, column) = src.getHandle(er.m_row, ii);
+							bx::memCopy(dst.getComponent(row, column), src.getComponent(er.m_row, ii), src.m_columns[ii].m_size);
+							dst.setVersion(row, column, src.getVersion(er.m_row, ii) );
+						}
 					}
+				}
+			}
+
+			if (kInvalidHandle != er.m_archetype)
+			{
+				EntityHandle moved = m_archetypes[er.m_archetype].free(er.m_row);
+				if (isValid(moved) )
+				{
+					m_entityRef[moved.idx].m_row = er.m_row;
+				}
+			}
+
+			er.m_archetype = _archetype;
+			er.m_row = row;
+		}
+
+		void entityRemoveComponent(EntityHandle _handle, ComponentTypeHandle _type)
+		{
+			const EntityRef& er = m_entityRef[_handle.idx];
+			const Archetype& src = m_archetypes[er.m_archetype];
+
+			ArchetypeColumn columns[MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY];
+			uint32_t num = 0;
+
+			for (uint32_t ii = 0; ii < src.m_numColumns; ++ii)
+			{
+				if (_type.idx != src.m_columns[ii].m_type.idx)
+				{
+					columns[num++] = src.m_columns[ii];
+				}
+			}
+
+			entityMove(_handle, 0 == num ? kInvalidHandle : findOrCreateArchetype(columns, num) );
+		}
+
+		void entityTakeOwnership(EntityHandle _handle)
+		{
+			entityDecRef(_handle);
+		}
+
+		void entityIncRef(EntityHandle _handle)
+		{
+			EntityRef& er = m_entityRef[_handle.idx];
+			++er.m_refCount;
+		}
+
+		void entityDecRef(EntityHandle _handle)
+		{
+			EntityRef& er = m_entityRef[_handle.idx];
+			int32_t refs = --er.m_refCount;
+			if (0 == refs)
+			{
+				m_entityHandle.free(_handle.idx);
+
+				if (kInvalidHandle != er.m_archetype)
+				{
+					const Archetype& archetype = m_archetypes[er.m_archetype];
+					for (uint32_t ii = 0; ii < archetype.m_numColumns; ++ii)
+					{
+						ComponentHandle handle = archetype.getHandle(er.m_row, ii);
+
+						ComponentRef& cr = m_componentRef[handle.idx];
+						cr.m_entity.idx = kInvalidHandle32;
+
+						if (er.m_destroyComponents
+						&&  1 == cr.m_refCount)
+						{
+							componentDecRef(handle);
+							continue;
+						}
+
+						// Move component data out of archetype, component can outlive entity.
+						cr.m_data = bx::alloc(g_allocator, cr.m_size);
+						bx::memCopy(cr.m_data, archetype.getComponent(er.m_row, ii), cr.m_size);
+
+						if (er.m_destroyComponents)
+						{
+							componentDecRef(handle);
+						}
+					}
+
+					entityMove(_handle, kInvalidHandle);
+				}
+			}
+		}
+
+		EntityHandle entityCreate(bool _destroyComponents)
+		{
+			EntityHandle handle = { m_entityHandle.alloc() };
+			if (isValid(handle))
+			{
+				m_entityRef.reserve(handle.idx + 1);
+
+				EntityRef& er = m_entityRef[handle.idx];
+				er.m_refCount = 1;
+				er.m_destroyComponents = _destroyComponents;
+				er.m_archetype = kInvalidHandle;
+				er.m_row = UINT32_MAX;
+			}
+			
+			return handle;
+		}
+
+		MAX_API_FUNC(EntityHandle createEntity(bool _destroyComponents))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			entityCheckStructural("createEntity");
+
+			return entityCreate(_destroyComponents);
+		}
+
+		MAX_API_FUNC(EntityHandle createEntities(uint32_t _num, const EntityPrototype& _prototype, bool _destroyComponents))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			entityCheckStructural("createEntities");
+
+			EntityHandle first = MAX_INVALID_HANDLE32;
+
+			const uint32_t numComponents = _prototype.m_num;
+			if (0 == _num
+			||  0 == numComponents)
+			{
+				BX_WARN(0 == _num, "Entity prototype has no components.");
+				return first;
+			}
+
+			if (numComponents > MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY)
+			{
+				BX_WARN(false, "Too many components per entity %d (max: %d).", numComponents, MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY);
+				return first;
+			}
+
+			ArchetypeColumn columns[MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY];
+			for (uint32_t ii = 0; ii < numComponents; ++ii)
+			{
+				if (!isValid(_prototype.m_types[ii]) )
+				{
+					BX_WARN(false, "Passing invalid component type to max::createEntities.");
+					return first;
+				}
+
+				for (uint32_t jj = 0; jj < ii; ++jj)
+				{
+					if (_prototype.m_types[jj].idx == _prototype.m_types[ii].idx)
+					{
+						BX_WARN(false, "Entity prototype has duplicate component types.");
+						return first;
+					}
+				}
+
+				if (!componentCheckSize(_prototype.m_types[ii], _prototype.m_size[ii]) )
+				{
+					return first;
+				}
+
+				columns[ii].m_type = _prototype.m_types[ii];
+				columns[ii].m_size = _prototype.m_size[ii];
+			}
+
+			const uint16_t archetypeIdx = findOrCreateArchetype(columns, numComponents);
+			if (kInvalidHandle == archetypeIdx)
+			{
+				return first;
+			}
+
+			Archetype& archetype = m_archetypes[archetypeIdx];
+
+			first.idx = m_entityHandle.allocRange(_num);
+			m_entityRef.reserve(first.idx + _num);
+
+			const uint32_t firstComponent = m_componentHandle.allocRange(_num*numComponents);
+			m_componentRef.reserve(firstComponent + _num*numComponents);
+
+			const uint32_t firstRow = archetype.alloc(first, _num);
+			const uint32_t version  = getChangeVersion();
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				EntityRef& er = m_entityRef[first.idx + ii];
+				er.m_refCount = 1;
+				er.m_destroyComponents = _destroyComponents;
+				er.m_archetype = archetypeIdx;
+				er.m_row = firstRow + ii;
+			}
+
+			for (uint32_t jj = 0; jj < numComponents; ++jj)
+			{
+				const ComponentTypeHandle type = _prototype.m_types[jj];
+				const uint32_t column = archetype.findColumn(type);
+				const uint32_t size = _prototype.m_size[jj];
+				const void* data = _prototype.m_data[jj];
+
+				// Components of prototype `jj` use consecutive handles.
+				const uint32_t base = firstComponent + jj*_num;
+
+				for (uint32_t ii = 0; ii < _num; ++ii)
+				{
+					ComponentRef& cr = m_componentRef[base + ii];
+					cr.m_refCount = 1;
+					cr.m_data = NULL;
+					cr.m_size = size;
+					cr.m_type = type;
+					cr.m_entity.idx = first.idx + ii;
+				}
+
+				// Fill archetype rows chunk by chunk.
+				for (uint32_t row = firstRow, end = firstRow + _num; row < end;)
+				{
+					const uint32_t chunk = row / archetype.m_capacity;
+					const uint32_t begin = row % archetype.m_capacity;
+					const uint32_t num   = bx::min(archetype.m_capacity - begin, end - row);
+
+					ComponentHandle* handles = &archetype.getHandles(chunk, column)[begin];
+					uint32_t* versions = &archetype.getVersions(chunk, column)[begin];
+					uint8_t* dst = archetype.getData(chunk, column) + begin*size;
+
+					for (uint32_t ii = 0; ii < num; ++ii)
+					{
+						handles[ii].idx = base + row - firstRow + ii;
+						versions[ii] = version;
+					}
+
+					if (NULL != data)
+					{
+						for (uint32_t ii = 0; ii < num; ++ii)
+						{
+							bx::memCopy(&dst[ii*size], data, size);
+						}
+					}
+
+					archetype.setVersion(row, column, version);
+
+					row += num;
+				}
+			}
+
+			return first;
+		}
+
+		bool entityAddComponent(EntityHandle _entity, ComponentHandle _component, ComponentTypeHandle _type, const void* _data)
+		{
+			if (!isValid(_type) )
+			{
+				BX_WARN(false, "Passing invalid component type to max::addComponent.");
+				return false;
+			}
+
+			EntityRef& er = m_entityRef[_entity.idx];
+			ComponentRef& cr = m_componentRef[_component.idx];
+
+			if (isValid(cr.m_entity) )
+			{
+				BX_WARN(false, "Component %d is already added to entity %d.", _component.idx, cr.m_entity.idx);
+				return false;
+			}
+
+			ArchetypeColumn columns[MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY];
+			uint32_t num = 0;
+
+			if (kInvalidHandle != er.m_archetype)
+			{
+				const Archetype& src = m_archetypes[er.m_archetype];
+				if (UINT32_MAX != src.findColumn(_type) )
+				{
+					BX_WARN(false, "Entity %d already has component of this type.", _entity.idx);
+					return false;
+				}
+
+				if (src.m_numColumns >= MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY)
+				{
+					BX_WARN(false, "Too many components per entity (max: %d).", MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY);
+					return false;
+				}
+
+				bx::memCopy(columns, src.m_columns, src.m_numColumns*sizeof(ArchetypeColumn) );
+				num = src.m_numColumns;
+			}
+
+			if (!componentCheckSize(_type, cr.m_size) )
+			{
+				return false;
+			}
+
+			columns[num].m_type = _type;
+			columns[num].m_size = cr.m_size;
+			++num;
+
+			const uint16_t archetype = findOrCreateArchetype(columns, num);
+			if (kInvalidHandle == archetype)
+			{
+				return false;
+			}
+
+			entityMove(_entity, archetype);
+
+			Archetype& dst = m_archetypes[archetype];
+			const uint32_t column = dst.findColumn(_type);
+			dst.getHandle(er.m_row, column) = _component;
+			dst.setVersion(er.m_row, column, getChangeVersion() );
+			if (NULL != _data)
+			{
+				bx::memCopy(dst.getComponent(er.m_row, column), _data, cr.m_size);
+			}
+
+			bx::free(g_allocator, cr.m_data);
+			cr.m_data = NULL;
+			cr.m_type = _type;
+			cr.m_entity = _entity;
+
+			return true;
+		}
+
+		MAX_API_FUNC(void addComponent(EntityHandle _entity, ComponentHandle _component, ComponentTypeHandle _type))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			entityCheckStructural("addComponent");
+
+			entityAddComponent(_entity, _component, _type, m_componentRef[_component.idx].m_data);
+		}
+
+		void entityDetachComponent(EntityHandle _entity, ComponentTypeHandle _type)
+		{
+			const EntityRef& er = m_entityRef[_entity.idx];
+			if (kInvalidHandle == er.m_archetype
+			||  !isValid(_type) )
+			{
+				return;
+			}
+
+			const Archetype& archetype = m_archetypes[er.m_archetype];
+			const uint32_t column = archetype.findColumn(_type);
+			if (UINT32_MAX == column)
+			{
+				return;
+			}
+
+			ComponentHandle handle = archetype.getHandle(er.m_row, column);
+			ComponentRef& cr = m_componentRef[handle.idx];
+
+			const bool destroy = er.m_destroyComponents;
+			if (destroy
+			&&  1 == cr.m_refCount)
+			{
+				componentDecRef(handle);
+				return;
+			}
+
+			// Component outlives entity, move its data out of archetype.
+			cr.m_data = bx::alloc(g_allocator, cr.m_size);
+			bx::memCopy(cr.m_data, archetype.getComponent(er.m_row, column), cr.m_size);
+			cr.m_entity.idx = kInvalidHandle32;
+
+			entityRemoveComponent(_entity, _type);
+
+			// Entity owned component, but it's still referenced elsewhere.
+			if (destroy)
+			{
+				componentDecRef(handle);
+			}
+		}
+
+		MAX_API_FUNC(void removeComponent(EntityHandle _entity, ComponentTypeHandle _type))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			entityCheckStructural("removeComponent");
+
+			MAX_CHECK_HANDLE("removeComponent", m_entityHandle, _entity);
+
+			entityDetachComponent(_entity, _type);
+		}
+
+		/// Version components are stamped with when changed, frame currently
+		/// being submitted.
+		uint32_t getChangeVersion() const
+		{
+			return m_submit->m_frameNum;
+		}
+
+		/// Lock-free entity lookup for `getComponent` and `markChanged`,
+		/// they are called from parallel systems. Temporary command buffer
+		/// handles and handles out of range are rejected.
+		const EntityRef* entityFind(EntityHandle _handle, const char* _func) const
+		{
+			MAX_CHECK_HANDLE(_func, m_entityHandle, _handle);
+
+			if (0 != (_handle.idx & EntityCommandBufferImpl::kTempEntityBit)
+			||  _handle.idx >= m_entityRef.getCapacity() )
+			{
+				BX_WARN(false, "%s: Invalid entity handle %d.", _func, _handle.idx);
+				return NULL;
+			}
+
+			return &m_entityRef[_handle.idx];
+		}
+
+		/// Structural changes (create, destroy, add or remove component)
+		/// must not overlap with parallel systems, which read entities
+		/// without lock. Use entity command buffers inside of systems.
+		void entityCheckStructural(const char* _func) const
+		{
+			BX_ASSERT(0 == m_numParallelEach
+				, "%s: Structural change while parallel system is running, use `max::beginEntityCommands`."
+				, _func
+				);
+			BX_UNUSED(_func);
+		}
+
+		MAX_API_FUNC(void* getComponent(EntityHandle _handle, ComponentTypeHandle _type, Access::Enum _access))
+		{
+			const EntityRef* ref = entityFind(_handle, "getComponent");
+			if (NULL == ref)
+			{
+				return NULL;
+			}
+
+			const EntityRef& er = *ref;
+			if (kInvalidHandle != er.m_archetype
+			&&  isValid(_type) )
+			{
+				Archetype& archetype = m_archetypes[er.m_archetype];
+				const uint32_t column = archetype.findColumn(_type);
+				if (UINT32_MAX != column)
+				{
+					if (Access::Read != _access)
+					{
+						archetype.setVersion(er.m_row, column, getChangeVersion() );
+					}
+
+					return archetype.getComponent(er.m_row, column);
+				}
+			}
+
+			return NULL;
+		}
+
+		MAX_API_FUNC(void markChanged(EntityHandle _handle, ComponentTypeHandle _type))
+		{
+			const EntityRef* ref = entityFind(_handle, "markChanged");
+			if (NULL == ref)
+			{
+				return;
+			}
+
+			const EntityRef& er = *ref;
+			if (kInvalidHandle != er.m_archetype
+			&&  isValid(_type) )
+			{
+				Archetype& archetype = m_archetypes[er.m_archetype];
+				const uint32_t column = archetype.findColumn(_type);
+				if (UINT32_MAX != column)
+				{
+					archetype.setVersion(er.m_row, column, getChangeVersion() );
+				}
+			}
+		}
+
+		/// Build entity query with entities that have all component types. When
+		/// `_sinceFrame` is not zero, only entities with any of listed
+		/// components changed in or after `_sinceFrame` are returned. Result
+		/// is allocated from frame arena and stays valid until next frame.
+		EntityQuery* entityQueryCreate(const ComponentTypeHandle* _types, uint32_t _num, uint32_t _sinceFrame)
+		{
+			const ArchetypeQuery& query = findOrCreateQuery(_types, _num);
+
+			uint32_t total = 0;
+			for (uint16_t ii = 0; ii < query.m_numArchetypes; ++ii)
+			{
+				total += m_archetypes[query.m_archetypes[ii] ].m_num;
+			}
+
+			EntityQuery* result = (EntityQuery*)m_queryArena.alloc(sizeof(EntityQuery) );
+			result->m_num = 0;
+			result->m_entities = (EntityHandle*)m_queryArena.alloc(bx::max<uint32_t>(total, 1)*sizeof(EntityHandle) );
+
+			uint32_t columns[MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY];
+
+			for (uint16_t ii = 0; ii < query.m_numArchetypes; ++ii)
+			{
+				const Archetype& archetype = m_archetypes[query.m_archetypes[ii] ];
+
+				if (0 == _sinceFrame)
+				{
+					for (uint32_t chunk = 0, numChunks = archetype.getNumChunks(); chunk < numChunks; ++chunk)
+					{
+						const uint32_t num = archetype.getNumRows(chunk);
+						bx::memCopy(&result->m_entities[result->m_num], archetype.getEntities(chunk), num*sizeof(EntityHandle) );
+						result->m_num += num;
+					}
+
+					continue;
+				}
+
+				for (uint32_t jj = 0; jj < _num; ++jj)
+				{
+					columns[jj] = archetype.findColumn(_types[jj]);
+				}
+
+				for (uint32_t chunk = 0, numChunks = archetype.getNumChunks(); chunk < numChunks; ++chunk)
+				{
+					// Skip whole chunk when none of its columns changed.
+					bool changed = false;
+					for (uint32_t jj = 0; jj < _num && !changed; ++jj)
+					{
+						changed = archetype.getChunkVersion(chunk, columns[jj]) >= _sinceFrame;
+					}
+
+					if (!changed)
+					{
+						continue;
+					}
+
+					const EntityHandle* entities = archetype.getEntities(chunk);
+					for (uint32_t row = 0, num = archetype.getNumRows(chunk); row < num; ++row)
+					{
+						for (uint32_t jj = 0; jj < _num; ++jj)
+						{
+							if (archetype.getVersions(chunk, columns[jj])[row] >= _sinceFrame)
+							{
+								result->m_entities[result->m_num++] = entities[row];
+								break;
+							}
+						}
+					}
+				}
+			}
+
+			return result;
+		}
+
+		MAX_API_FUNC(EntityQuery* queryEntities(const ComponentTypeHandle* _types, uint32_t _num))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			return entityQueryCreate(_types, _num, 0);
+		}
+
+		MAX_API_FUNC(EntityQuery* queryChangedEntities(const ComponentTypeHandle* _types, uint32_t _num, uint32_t _sinceFrame))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			return entityQueryCreate(_types, _num, _sinceFrame);
+		}
+
+		MAX_API_FUNC(ChunkQuery* queryChunks(const ComponentTypeHandle* _types, uint32_t _num))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			BX_ASSERT(_num <= MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY, "Too many components in query %d (max: %d)."
+				, _num
+				, MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY
+				);
+
+			const ArchetypeQuery& query = findOrCreateQuery(_types, _num);
+
+			uint32_t total = 0;
+			for (uint16_t ii = 0; ii < query.m_numArchetypes; ++ii)
+			{
+				total += m_archetypes[query.m_archetypes[ii] ].getNumChunks();
+			}
+
+			total = bx::max<uint32_t>(total, 1);
+
+			ChunkQuery* result = (ChunkQuery*)m_queryArena.alloc(sizeof(ChunkQuery) );
+			result->m_num = 0;
+			result->m_numComponents = _num;
+			result->m_numEntities = (uint32_t*)m_queryArena.alloc(total*sizeof(uint32_t) );
+			result->m_entities = (EntityHandle**)m_queryArena.alloc(total*sizeof(EntityHandle*) );
+			result->m_components = (void**)m_queryArena.alloc(total*_num*sizeof(void*) );
+
+			uint32_t columns[MAX_CONFIG_MAX_COMPONENTS_PER_ENTITY];
+
+			for (uint16_t ii = 0; ii < query.m_numArchetypes; ++ii)
+			{
+				const Archetype& archetype = m_archetypes[query.m_archetypes[ii] ];
+
+				for (uint32_t jj = 0; jj < _num; ++jj)
+				{
+					columns[jj] = archetype.findColumn(_types[jj]);
+				}
+
+				for (uint32_t chunk = 0, numChunks = archetype.getNumChunks(); chunk < numChunks; ++chunk)
+				{
+					const uint32_t idx = result->m_num++;
+					result->m_numEntities[idx] = archetype.getNumRows(chunk);
+					result->m_entities[idx] = archetype.getEntities(chunk);
+
+					for (uint32_t jj = 0; jj < _num; ++jj)
+					{
+						result->m_components[idx*_num + jj] = archetype.getData(chunk, columns[jj]);
+					}
+				}
+			}
+
+			return result;
+		}
+
+		struct ParallelEach
+		{
+			Context* m_ctx;
+			const EntityHandle* m_entities;
+			SystemParallelFn m_func;
+			void* m_userData;
+
+			/// Ranges that didn't get encoder, executed by caller with its own
+			/// encoder after join.
+			uint32_t m_deferred[MAX_CONFIG_MAX_JOB_THREADS + 1][2];
+			int32_t  m_numDeferred;
+		};
+
+		static void parallelEachRange(uint32_t _begin, uint32_t _end, void* _userData)
+		{
+			ParallelEach& pe = *(ParallelEach*)_userData;
+
+			Encoder* encoder = pe.m_ctx->begin(true);
+			if (NULL == encoder)
+			{
+				// Encoders were taken by other threads after ranges were
+				// split, caller runs this range with its own encoder.
+				const int32_t idx = bx::atomicFetchAndAdd<int32_t>(&pe.m_numDeferred, 1);
+				pe.m_deferred[idx][0] = _begin;
+				pe.m_deferred[idx][1] = _end;
+				return;
+			}
+
+			for (uint32_t ii = _begin; ii < _end; ++ii)
+			{
+				pe.m_func(encoder, pe.m_entities[ii], pe.m_userData);
+			}
+
+			pe.m_ctx->end(encoder);
+		}
+
+		MAX_API_FUNC(void parallelEach(const EntityHandle* _entities, uint32_t _num, SystemParallelFn _func, void* _userData, uint32_t _grain))
+		{
+			// Acquire caller's encoder before ranges take free encoders, it
+			// runs ranges that didn't get encoder of their own. API thread
+			// always has one, other threads might not.
+			Encoder* encoder = begin(false);
+			if (NULL == encoder)
+			{
+				BX_WARN(false, "No free encoder for thread calling parallelEach, entities are skipped.");
+				return;
+			}
+
+			bx::atomicFetchAndAdd<int32_t>(&m_numParallelEach, 1);
+
+			ParallelEach pe;
+			pe.m_ctx = this;
+			pe.m_entities = _entities;
+			pe.m_func = _func;
+			pe.m_userData = _userData;
+			pe.m_numDeferred = 0;
+
+			// Each range needs its own encoder, don't split into more ranges
+			// than there are free encoders.
+#if MAX_CONFIG_MULTITHREADED
+			uint32_t maxRanges;
+			{
+				bx::MutexScope scopeLock(m_encoderApiLock);
+				maxRanges = m_encoderHandle->getMaxHandles() - m_encoderHandle->getNumHandles();
+			}
+#else
+			// There is only API thread encoder.
+			const uint32_t maxRanges = 1;
+#endif // MAX_CONFIG_MULTITHREADED
+
+			m_jobPool.parallelFor(_num, _grain, bx::max<uint32_t>(maxRanges, 1), parallelEachRange, &pe);
+
+			for (int32_t ii = 0; ii < pe.m_numDeferred; ++ii)
+			{
+				for (uint32_t jj = pe.m_deferred[ii][0], last = pe.m_deferred[ii][1]; jj < last; ++jj)
+				{
+					_func(encoder, _entities[jj], _userData);
+				}
+			}
+
+			end(encoder);
+
+			bx::atomicFetchAndSub<int32_t>(&m_numParallelEach, 1);
+		}
+
+		MAX_API_FUNC(EntityCommandBuffer* beginEntityCommands() )
+		{
+			MAX_MUTEX_SCOPE(m_entityCommandsLock);
+
+			uint16_t idx = m_entityCommandsHandle.alloc();
+			if (kInvalidHandle == idx)
+			{
+				BX_WARN(false, "Too many entity command buffers in flight (max: %d).", MAX_CONFIG_MAX_ENTITY_COMMAND_BUFFERS);
+				return NULL;
+			}
+
+			EntityCommandBufferImpl& commands = m_entityCommands[idx];
+			commands.reset();
+			commands.m_idx = idx;
+
+			return reinterpret_cast<EntityCommandBuffer*>(&commands);
+		}
+
+		MAX_API_FUNC(void end(EntityCommandBuffer* _commands) )
+		{
+			MAX_MUTEX_SCOPE(m_entityCommandsLock);
+
+			EntityCommandBufferImpl& commands = *reinterpret_cast<EntityCommandBufferImpl*>(_commands);
+			if (!m_entityCommandsHandle.isValid(commands.m_idx)
+			||  commands.m_ended)
+			{
+				BX_WARN(false, "Entity command buffer is already ended.");
+				return;
+			}
+
+			commands.m_ended = true;
+			m_entityCommandsQueue[m_numEntityCommandsQueued++] = commands.m_idx;
+		}
+
+		EntityHandle entityCommandsRemap(const EntityCommandBufferImpl& _commands, EntityHandle _handle) const
+		{
+			if (isValid(_handle)
+			&&  0 != (_handle.idx & EntityCommandBufferImpl::kTempEntityBit) )
+			{
+				const uint32_t buffer = (_handle.idx & EntityCommandBufferImpl::kTempBufferMask) >> EntityCommandBufferImpl::kTempBufferShift;
+				const uint32_t local  =  _handle.idx & EntityCommandBufferImpl::kTempEntityMask;
+
+				if (buffer != _commands.m_idx
+				||  local  >= m_entityCommandsRemap.size() )
+				{
+					BX_WARN(false, "Temporary entity handle 0x%08x is not created by this command buffer.", _handle.idx);
+					EntityHandle invalid = MAX_INVALID_HANDLE32;
+					return invalid;
+				}
+
+				return m_entityCommandsRemap[local];
+			}
+
+			return _handle;
+		}
+
+		void entityCommandsPlayback(EntityCommandBufferImpl& _commands)
+		{
+			const EntityHandle invalid = MAX_INVALID_HANDLE32;
+			m_entityCommandsRemap.clear();
+			m_entityCommandsRemap.resize(_commands.m_numEntities, invalid);
+
+			bx::MemoryReader reader(_commands.m_buffer, _commands.m_pos);
+
+			bx::ErrorAssert err;
+
+			while (0 < reader.remaining() )
+			{
+				EntityCommandBufferImpl::Command::Enum command;
+				bx::read(&reader, command, &err);
+
+				switch (command)
+				{
+				case EntityCommandBufferImpl::Command::CreateEntity:
+					{
+						uint32_t local;
+						bx::read(&reader, local, &err);
+						bool destroyComponents;
+						bx::read(&reader, destroyComponents, &err);
+
+						m_entityCommandsRemap[local] = entityCreate(destroyComponents);
+					}
+					break;
+
+				case EntityCommandBufferImpl::Command::DestroyEntity:
+					{
+						EntityHandle handle;
+						bx::read(&reader, handle, &err);
+						handle = entityCommandsRemap(_commands, handle);
+
+						if (m_entityHandle.isValid(handle.idx) )
+						{
+							entityDecRef(handle);
+						}
+					}
+					break;
+
+				case EntityCommandBufferImpl::Command::AddComponent:
+					{
+						EntityHandle handle;
+						bx::read(&reader, handle, &err);
+						ComponentTypeHandle type;
+						bx::read(&reader, type, &err);
+						uint32_t size;
+						bx::read(&reader, size, &err);
+
+						const void* data = reader.getDataPtr();
+						reader.seek(size, bx::Whence::Current);
+
+						handle = entityCommandsRemap(_commands, handle);
+						if (m_entityHandle.isValid(handle.idx) )
+						{
+							ComponentHandle component = componentCreate(NULL, size);
+							if (!entityAddComponent(handle, component, type, data) )
+							{
+								componentDecRef(component);
+							}
+						}
+					}
+					break;
+
+				case EntityCommandBufferImpl::Command::RemoveComponent:
+					{
+						EntityHandle handle;
+						bx::read(&reader, handle, &err);
+						ComponentTypeHandle type;
+						bx::read(&reader, type, &err);
+
+						handle = entityCommandsRemap(_commands, handle);
+						if (m_entityHandle.isValid(handle.idx) )
+						{
+							entityDetachComponent(handle, type);
+						}
+					}
+					break;
+
+				default:
+					BX_ASSERT(false, "Invalid entity command %d.", command);
+					break;
+				}
+			}
+		}
+
+		void entityCommandsFlush()
+		{
+			MAX_MUTEX_SCOPE(m_entityCommandsLock);
+
+			if (0 == m_numEntityCommandsQueued)
+			{
+				return;
+			}
 
-					if (isValid(handle))
-					{
-						destroyComponent(handle);
-					}
-				}
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
 
-				er.m_components.reset();
+			for (uint16_t ii = 0; ii < m_numEntityCommandsQueued; ++ii)
+			{
+				const uint16_t idx = m_entityCommandsQueue[ii];
+				entityCommandsPlayback(m_entityCommands[idx]);
+				m_entityCommandsHandle.free(idx);
 			}
+
+			m_numEntityCommandsQueued = 0;
 		}
 
-		MAX_API_FUNC(EntityHandle createEntity(bool _destroyComponents))
+		MAX_API_FUNC(void destroyEntity(EntityHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			entityCheckStructural("destroyEntity");
 
-			EntityHandle handle = { m_entityHandle.alloc() };
-			if (isValid(handle))
+			MAX_CHECK_HANDLE("destroyEntity", m_entityHandle, _handle);
+
+			if (!isValid(_handle))
 			{
-				EntityRef& er = m_entityRef[handle.idx];
-				er.m_refCount = 1;
-				er.m_destroyComponents = _destroyComponents;
-				er.m_components.reset();
+				BX_WARN(false, "Passing invalid entity handle to max::destroyEntity.");
+				return;
 			}
-			
-			return handle;
+
+			entityDecRef(_handle);
 		}
 
-		MAX_API_FUNC(void addComponent(EntityHandle _entity, ComponentHandle _component, uint32_t _hash))
+		MAX_API_FUNC(void destroyEntities(EntityHandle _first, uint32_t _num))
 		{
-			EntityRef& er = m_entityRef[_entity.idx];
-			er.m_components.insert(_hash, _component.idx);
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			entityCheckStructural("destroyEntities");
+
+			// Destroy in reverse, entities created together occupy the tail of
+			// their archetype and are removed without moving other rows.
+			for (uint32_t ii = _num; ii > 0; --ii)
+			{
+				EntityHandle handle = { _first.idx + ii - 1 };
+
+				MAX_CHECK_HANDLE("destroyEntities", m_entityHandle, handle);
+
+				if (m_entityHandle.isValid(handle.idx) )
+				{
+					entityDecRef(handle);
+				}
+			}
 		}
 
-		MAX_API_FUNC(void* getComponent(EntityHandle _handle, uint32_t _hash))
+		MAX_API_FUNC(BodyHandle createBody(CollisionShape::Enum _shape, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags))
 		{
-			EntityRef& er = m_entityRef[_handle.idx];
-			ComponentHandle handle = { er.m_components.find(_hash) };
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
+
+			BodyHandle handle = bodyAlloc();
 			if (isValid(handle))
 			{
-				ComponentRef& cr = m_componentRef[handle.idx];
-				return cr.m_data;  
+				m_physicsCtx->createBody(handle, _shape, _pos, _quat, _scale, _layer, _motion, _activation, _maxVelocity, _flags);
+				bodySeedTransform(handle);
 			}
 
-			return NULL;
+			return handle;
 		}
 
-		MAX_API_FUNC(EntityQuery* queryEntities(const HashQuery& _hashes))
+		MAX_API_FUNC(BodyHandle createBody(CollisionShape::Enum _shape, MeshHandle _mesh, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
 
-			m_entityQuery.m_num = 0;
+			MAX_CHECK_HANDLE("createBody", m_meshHandle, _mesh);
+			BX_ASSERT(CollisionShape::Mesh <= _shape && CollisionShape::Count > _shape
+				, "Shape %d can't be created from mesh."
+				, _shape
+				);
 
-			for (uint16_t idx = 0, end = MAX_CONFIG_MAX_ENTITIES; idx < end; ++idx)
+			if (CollisionShape::Mesh == _shape
+			&&  MotionType::Dynamic == _motion)
 			{
-				EntityHandle handle = { idx };
-				if (!isValid(handle))
-				{
-					continue;
-				}
+				BX_WARN(false, "Mesh collision shape can't be dynamic, use convex hull instead.");
+				return MAX_INVALID_HANDLE;
+			}
 
-				EntityRef& er = m_entityRef[handle.idx];
-				if (er.m_components.getNumElements() <= 0)
-				{
-					// @todo I dont like that I need to do this check. Because an entity can be deleted.
-					continue;
-				}
+			if (CollisionShape::HeightField == _shape
+			&&  MotionType::Static != _motion)
+			{
+				BX_WARN(false, "Height field collision shape must be static.");
+				return MAX_INVALID_HANDLE;
+			}
 
-				bool matches = true;
-				for (uint32_t ii = 0; ii < _hashes.m_num; ++ii)
+			const MeshRef& mr = m_meshRef[_mesh.idx];
+			for (GroupArray::const_iterator it = mr.m_groups.begin(), itEnd = mr.m_groups.end(); it != itEnd; ++it)
+			{
+				if (NULL == it->m_vertices
+				|| (NULL == it->m_indices && CollisionShape::Mesh == _shape) )
 				{
-					uint32_t hash = _hashes.m_data[ii];
-					if (er.m_components.find(hash) == bx::kInvalidHandle)
-					{
-						matches = false;
-						break;
-					}
+					BX_WARN(false, "Mesh %d has no RAM copy, create it with `_ramcopy` to use it as collision shape.", _mesh.idx);
+					return MAX_INVALID_HANDLE;
 				}
+			}
 
-				if (matches)
+			BodyHandle handle = bodyAlloc();
+			if (isValid(handle))
+			{
+				if (!m_physicsCtx->createMeshBody(handle, _shape, mr, _pos, _quat, _scale, _layer, _motion, _activation, _maxVelocity, _flags) )
 				{
-					m_entityQuery.m_entities[m_entityQuery.m_num] = handle;
-					++m_entityQuery.m_num;
+					m_bodyHandle.free(handle.idx);
+					return MAX_INVALID_HANDLE;
 				}
+
+				bodySeedTransform(handle);
 			}
 
-			return &m_entityQuery;
+			return handle;
 		}
 
-		MAX_API_FUNC(void destroyEntity(EntityHandle _handle))
+		/// Allocate body handle, limited by `Init::Physics::maxBodies`. Handles
+		/// of destroyed bodies are released at end of frame, but their bodies
+		/// no longer count against the limit.
+		BodyHandle bodyAlloc()
 		{
-			MAX_MUTEX_SCOPE(m_resourceApiLock);
-
-			MAX_CHECK_HANDLE("destroyEntity", m_entityHandle, _handle);
-
-			if (!isValid(_handle))
+			const uint32_t numBodies = m_bodyHandle.getNumHandles() - m_numFreeBodyHandles;
+			if (numBodies >= m_init.physics.maxBodies)
 			{
-				BX_WARN(false, "Passing invalid entity handle to max::destroyEntity.");
-				return;
+				BX_WARN(false, "Too many bodies (max: %d).", m_init.physics.maxBodies);
+				BodyHandle invalid = MAX_INVALID_HANDLE;
+				return invalid;
 			}
 
-			entityDecRef(_handle);
+			BodyHandle handle = { m_bodyHandle.alloc() };
+			return handle;
 		}
 
-		MAX_API_FUNC(BodyHandle createBody(CollisionShape::Enum _shape, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags))
+		/// Seed published transforms, body is not part of them until physics
+		/// thread publishes next time.
+		void bodySeedTransform(BodyHandle _handle)
 		{
-			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			BodyTransform transform;
+			bx::store(transform.m_pos, m_physicsCtx->getPosition(_handle) );
+			bx::store(transform.m_rot, m_physicsCtx->getRotation(_handle) );
 
-			BodyHandle handle = { m_bodyHandle.alloc() };
-			if (isValid(handle))
+			for (uint32_t ii = 0; ii < BX_COUNTOF(m_physicsFrame); ++ii)
 			{
-				m_physicsCtx->createBody(handle, _shape, _pos, _quat, _scale, _layer, _motion, _activation, _maxVelocity, _flags);
+				m_physicsFrame[ii].m_prev[_handle.idx] = transform;
+				m_physicsFrame[ii].m_curr[_handle.idx] = transform;
 			}
-
-			return handle;
 		}
 
 		MAX_API_FUNC(void setPosition(BodyHandle _handle, const bx::Vec3& _pos, Activation::Enum _activation))
@@ -7611,12 +9382,21 @@ namespace max
 
 			MAX_CHECK_HANDLE("setPosition", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::SetPosition, _handle, _activation);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _pos);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->setPosition(_handle, _pos, _activation);
 		}
 
 		MAX_API_FUNC(bx::Vec3 getPosition(BodyHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
 
 			MAX_CHECK_HANDLE("getPosition", m_bodyHandle, _handle);
 
@@ -7629,12 +9409,21 @@ namespace max
 
 			MAX_CHECK_HANDLE("setRotation", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::SetRotation, _handle, _activation);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _rot);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->setRotation(_handle, _rot, _activation);
 		}
 
 		MAX_API_FUNC(bx::Quaternion getRotation(BodyHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
 
 			MAX_CHECK_HANDLE("getRotation", m_bodyHandle, _handle);
 
@@ -7647,12 +9436,21 @@ namespace max
 
 			MAX_CHECK_HANDLE("setLinearVelocity", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::SetLinearVelocity, _handle);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _velocity);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->setLinearVelocity(_handle, _velocity);
 		}
 
 		MAX_API_FUNC(bx::Vec3 getLinearVelocity(BodyHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
 
 			MAX_CHECK_HANDLE("getLinearVelocity", m_bodyHandle, _handle);
 
@@ -7665,12 +9463,21 @@ namespace max
 
 			MAX_CHECK_HANDLE("setAngularVelocity", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::SetAngularVelocity, _handle);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _angularVelocity);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->setAngularVelocity(_handle, _angularVelocity);
 		}
 
 		MAX_API_FUNC(bx::Vec3 getAngularVelocity(BodyHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
 
 			MAX_CHECK_HANDLE("getAngularVelocity", m_bodyHandle, _handle);
 
@@ -7683,6 +9490,15 @@ namespace max
 
 			MAX_CHECK_HANDLE("addLinearAndAngularVelocity", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::AddLinearAndAngularVelocity, _handle);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _linearVelocity);
+				bx::store(&cmd->m_data[3], _angularVelocity);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->addLinearAndAngularVelocity(_handle, _linearVelocity, _angularVelocity);
 		}
 
@@ -7692,6 +9508,14 @@ namespace max
 
 			MAX_CHECK_HANDLE("addLinearImpulse", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::AddLinearImpulse, _handle);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _impulse);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->addLinearImpulse(_handle, _impulse);
 		}
 
@@ -7701,6 +9525,14 @@ namespace max
 
 			MAX_CHECK_HANDLE("addAngularImpulse", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::AddAngularImpulse, _handle);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _impulse);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->addAngularImpulse(_handle, _impulse);
 		}
 
@@ -7710,7 +9542,22 @@ namespace max
 
 			MAX_CHECK_HANDLE("addBuoyancyImpulse", m_bodyHandle, _handle);
 
-			return m_physicsCtx->addBuoyancyImpulse(_handle, _surfacePosition, _surfaceNormal, _buoyancy, _linearDrag, _angularDrag, _fluidVelocity, _gravity, _deltaTime);
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::AddBuoyancyImpulse, _handle);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _surfacePosition);
+				bx::store(&cmd->m_data[3], _surfaceNormal);
+				cmd->m_data[6] = _buoyancy;
+				cmd->m_data[7] = _linearDrag;
+				cmd->m_data[8] = _angularDrag;
+				bx::store(&cmd->m_data[9],  _fluidVelocity);
+				bx::store(&cmd->m_data[12], _gravity);
+				cmd->m_data[15] = _deltaTime;
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
+			m_physicsCtx->addBuoyancyImpulse(_handle, _surfacePosition, _surfaceNormal, _buoyancy, _linearDrag, _angularDrag, _fluidVelocity, _gravity, _deltaTime);
 		}
 
 		MAX_API_FUNC(void addForce(BodyHandle _handle, const bx::Vec3& _force, Activation::Enum _activation))
@@ -7719,6 +9566,14 @@ namespace max
 
 			MAX_CHECK_HANDLE("addForce", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::AddForce, _handle, _activation);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _force);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->addForce(_handle, _force,  _activation);
 		}
 
@@ -7728,6 +9583,14 @@ namespace max
 
 			MAX_CHECK_HANDLE("addTorque", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::AddTorque, _handle, _activation);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _torque);
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->addTorque(_handle, _torque, _activation);
 		}
 
@@ -7737,21 +9600,132 @@ namespace max
 
 			MAX_CHECK_HANDLE("addMovement", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::AddMovement, _handle);
+			if (NULL != cmd)
+			{
+				bx::store(&cmd->m_data[0], _position);
+				bx::store(&cmd->m_data[3], _rotation);
+				cmd->m_data[7] = _deltaTime;
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->addMovement(_handle, _position, _rotation, _deltaTime);
 		}
 
+		MAX_API_FUNC(void getBodyTransforms(const BodyHandle* _handles, uint32_t _num, bx::Vec3* _positions, bx::Quaternion* _rotations))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				MAX_CHECK_HANDLE("getBodyTransforms", m_bodyHandle, _handles[ii]);
+			}
+
+			m_physicsCtx->getTransforms(_handles, _num, _positions, _rotations);
+		}
+
+		MAX_API_FUNC(void setPositions(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _positions, Activation::Enum _activation))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				MAX_CHECK_HANDLE("setPositions", m_bodyHandle, _handles[ii]);
+			}
+
+			if (m_physicsPending)
+			{
+				for (uint32_t ii = 0; ii < _num; ++ii)
+				{
+					PhysicsCommand* cmd = physicsQueue(PhysicsCommand::SetPosition, _handles[ii], _activation);
+					bx::store(&cmd->m_data[0], _positions[ii]);
+				}
+
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
+			m_physicsCtx->setPositions(_handles, _num, _positions, _activation);
+		}
+
+		MAX_API_FUNC(void addForces(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _forces, Activation::Enum _activation))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				MAX_CHECK_HANDLE("addForces", m_bodyHandle, _handles[ii]);
+			}
+
+			if (m_physicsPending)
+			{
+				for (uint32_t ii = 0; ii < _num; ++ii)
+				{
+					PhysicsCommand* cmd = physicsQueue(PhysicsCommand::AddForce, _handles[ii], _activation);
+					bx::store(&cmd->m_data[0], _forces[ii]);
+				}
+
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
+			m_physicsCtx->addForces(_handles, _num, _forces, _activation);
+		}
+
+		MAX_API_FUNC(uint32_t getActiveBodies(BodyHandle* _handles, uint32_t _max))
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
+
+			return m_physicsCtx->getActiveBodies(_handles, _max);
+		}
+
+		MAX_API_FUNC(void rayCast(const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits))
+		{
+			MAX_MUTEX_SCOPE(m_physicsLock);
+
+			m_physicsCtx->rayCast(_rays, _num, _hits);
+		}
+
+		MAX_API_FUNC(void shapeCast(CollisionShape::Enum _shape, const bx::Vec3& _scale, const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits))
+		{
+			MAX_MUTEX_SCOPE(m_physicsLock);
+
+			BX_ASSERT(CollisionShape::Mesh > _shape, "Shape %d can't be used for shape cast.", _shape);
+			m_physicsCtx->shapeCast(_shape, _scale, _rays, _num, _hits);
+		}
+
+		MAX_API_FUNC(void overlap(CollisionShape::Enum _shape, const bx::Vec3& _scale, const bx::Vec3* _positions, uint32_t _num, BodyHandle* _bodies, uint32_t _maxBodies, uint32_t* _numBodies))
+		{
+			MAX_MUTEX_SCOPE(m_physicsLock);
+
+			BX_ASSERT(CollisionShape::Mesh > _shape, "Shape %d can't be used for overlap test.", _shape);
+			m_physicsCtx->overlap(_shape, _scale, _positions, _num, _bodies, _maxBodies, _numBodies);
+		}
+
 		MAX_API_FUNC(void setFriction(BodyHandle _handle, float _friction))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
 
 			MAX_CHECK_HANDLE("setFriction", m_bodyHandle, _handle);
 
+			PhysicsCommand* cmd = physicsQueue(PhysicsCommand::SetFriction, _handle);
+			if (NULL != cmd)
+			{
+				cmd->m_data[0] = _friction;
+				return;
+			}
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
 			m_physicsCtx->setFriction(_handle, _friction);
 		}
 
 		MAX_API_FUNC(float getFriction(BodyHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
 
 			MAX_CHECK_HANDLE("getFriction", m_bodyHandle, _handle);
 
@@ -7761,6 +9735,7 @@ namespace max
 		MAX_API_FUNC(void getGroundInfo(BodyHandle _handle, GroundInfo& _info))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
 
 			MAX_CHECK_HANDLE("getGroundInfo", m_bodyHandle, _handle);
 
@@ -7770,9 +9745,20 @@ namespace max
 		MAX_API_FUNC(void destroyBody(BodyHandle _handle))
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
+			MAX_MUTEX_SCOPE(m_physicsLock);
 
 			MAX_CHECK_HANDLE("destroyBody", m_bodyHandle, _handle);
 
+			// Drop writes queued for body.
+			for (uint32_t ii = 0, num = uint32_t(m_physicsCommands.size() ); ii < num; ++ii)
+			{
+				PhysicsCommand& cmd = m_physicsCommands[ii];
+				if (cmd.m_handle.idx == _handle.idx)
+				{
+					cmd.m_handle.idx = kInvalidHandle;
+				}
+			}
+
 			m_physicsCtx->destroyBody(_handle);
 
 			m_freeBodyHandle[m_numFreeBodyHandles++] = _handle;
@@ -7780,9 +9766,115 @@ namespace max
 
 		MAX_API_FUNC(const bx::Vec3 getGravity())
 		{
+			MAX_MUTEX_SCOPE(m_physicsLock);
+
 			return m_physicsCtx->getGravity();
 		}
 
+		MAX_API_FUNC(const ContactEvent* getContactEvents(uint32_t* _num) )
+		{
+			return m_physicsCtx->getContactEvents(_num);
+		}
+
+		MAX_API_FUNC(const ActivationEvent* getActivationEvents(uint32_t* _num) )
+		{
+			return m_physicsCtx->getActivationEvents(_num);
+		}
+
+		MAX_API_FUNC(uint32_t savePhysicsState(void* _data, uint32_t _size, PhysicsState::Enum _state) )
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			// Snapshot must not contain half of fixed step batch.
+			physicsSync();
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
+			return m_physicsCtx->saveState(_data, _size, _state);
+		}
+
+		MAX_API_FUNC(bool restorePhysicsState(const void* _data, uint32_t _size) )
+		{
+			MAX_MUTEX_SCOPE(m_resourceApiLock);
+
+			physicsSync();
+
+			MAX_MUTEX_SCOPE(m_physicsLock);
+			if (!m_physicsCtx->restoreState(_data, _size) )
+			{
+				BX_TRACE("Failed to restore physics state.");
+				return false;
+			}
+
+			// Don't interpolate from pre-restore transforms.
+			physicsSeedTransforms();
+			return true;
+		}
+
+		MAX_API_FUNC(float getPhysicsAlpha() )
+		{
+			return m_physicsFrame[m_physicsRead].m_alpha;
+		}
+
+		MAX_API_FUNC(void getInterpolatedTransform(BodyHandle _handle, bx::Vec3& _pos, bx::Quaternion& _rot) )
+		{
+			MAX_CHECK_HANDLE("getInterpolatedTransform", m_bodyHandle, _handle);
+
+			const PhysicsFrame& frame = m_physicsFrame[m_physicsRead];
+			const BodyTransform& prev = frame.m_prev[_handle.idx];
+			const BodyTransform& curr = frame.m_curr[_handle.idx];
+			const float alpha = frame.m_alpha;
+
+			_pos = bx::lerp(bx::load<bx::Vec3>(prev.m_pos), bx::load<bx::Vec3>(curr.m_pos), alpha);
+
+			// Normalized lerp, flip sign to take shortest path.
+			const float dot  = bx::dot(bx::load<bx::Quaternion>(prev.m_rot), bx::load<bx::Quaternion>(curr.m_rot) );
+			const float sign = dot < 0.0f ? -1.0f : 1.0f;
+			const float aa   = 1.0f - alpha;
+			const float bb   = alpha * sign;
+
+			const bx::Quaternion rot =
+			{
+				prev.m_rot[0]*aa + curr.m_rot[0]*bb,
+				prev.m_rot[1]*aa + curr.m_rot[1]*bb,
+				prev.m_rot[2]*aa + curr.m_rot[2]*bb,
+				prev.m_rot[3]*aa + curr.m_rot[3]*bb,
+			};
+
+			_rot = bx::normalize(rot);
+		}
+
+		// physics thread
+		void physicsInit(const Init& _init);
+		void physicsShutdown();
+		void physicsUpdate(float _dt);
+		void physicsSync();
+		void physicsSeedTransforms();
+		void physicsStep();
+		void physicsReplay();
+
+		/// Returns command to record body write into while fixed step batch
+		/// is in flight, or NULL when write can be applied directly.
+		PhysicsCommand* physicsQueue(PhysicsCommand::Enum _type, BodyHandle _handle, Activation::Enum _activation = Activation::DontActivate)
+		{
+			if (!m_physicsPending)
+			{
+				return NULL;
+			}
+
+			m_physicsCommands.push_back(PhysicsCommand() );
+
+			PhysicsCommand& cmd = m_physicsCommands.back();
+			cmd.m_handle     = _handle;
+			cmd.m_type       = uint8_t(_type);
+			cmd.m_activation = uint8_t(_activation);
+
+			return &cmd;
+		}
+
+#if MAX_CONFIG_MULTITHREADED
+		static int32_t physicsThread(bx::Thread* /*_self*/, void* _userData);
+#endif // MAX_CONFIG_MULTITHREADED
+
 		MAX_API_FUNC(OcclusionQueryHandle createOcclusionQuery() )
 		{
 			MAX_MUTEX_SCOPE(m_resourceApiLock);
@@ -8153,6 +10245,9 @@ namespace max
 		uint32_t      m_numEncoders;
 		bx::HandleAlloc* m_encoderHandle;
 
+		JobPool m_jobPool;
+		JobPool m_ioJobPool;
+
 		Frame  m_frame[1+(MAX_CONFIG_MULTITHREADED ? 1 : 0)];
 		Frame* m_render;
 		Frame* m_submit;
@@ -8190,8 +10285,8 @@ namespace max
 		bx::HandleAllocT<MAX_CONFIG_MAX_FRAME_BUFFERS> m_frameBufferHandle;
 		bx::HandleAllocT<MAX_CONFIG_MAX_UNIFORMS> m_uniformHandle;
 		bx::HandleAllocT<MAX_CONFIG_MAX_MESHES> m_meshHandle;
-		bx::HandleAllocT<MAX_CONFIG_MAX_COMPONENTS> m_componentHandle;
-		bx::HandleAllocT<MAX_CONFIG_MAX_ENTITIES> m_entityHandle;
+		HandleAlloc32 m_componentHandle;
+		HandleAlloc32 m_entityHandle;
 		bx::HandleAllocT<MAX_CONFIG_MAX_BODIES> m_bodyHandle;
 		bx::HandleAllocT<MAX_CONFIG_MAX_OCCLUSION_QUERIES> m_occlusionQueryHandle;
 
@@ -8211,14 +10306,36 @@ namespace max
 		MeshHashMap m_meshHashMap;
 		MeshRef		m_meshRef[MAX_CONFIG_MAX_MESHES];
 
+		bx::HandleAllocT<MAX_CONFIG_MAX_ASYNC_LOADS> m_asyncLoadHandle;
+		AsyncLoad m_asyncLoads[MAX_CONFIG_MAX_ASYNC_LOADS];
+
 		TextureRef      m_textureRef[MAX_CONFIG_MAX_TEXTURES];
 		FrameBufferRef  m_frameBufferRef[MAX_CONFIG_MAX_FRAME_BUFFERS];
-		EntityRef	    m_entityRef[MAX_CONFIG_MAX_ENTITIES];
-		ComponentRef	m_componentRef[MAX_CONFIG_MAX_COMPONENTS];
+		PagedArray<EntityRef>    m_entityRef;
+		PagedArray<ComponentRef> m_componentRef;
 		VertexLayoutRef m_vertexLayoutRef;
 
+		typedef bx::HandleHashMapT<MAX_CONFIG_MAX_ARCHETYPES*2> ArchetypeHashMap;
+		ArchetypeHashMap m_archetypeHashMap;
+		PagedArray<Archetype, MAX_CONFIG_ECS_ARCHETYPE_PAGE_SIZE> m_archetypes;
+		uint16_t         m_numArchetypes;
+
+		typedef bx::HandleHashMapT<MAX_CONFIG_MAX_ENTITY_QUERIES*2> EntityQueryHashMap;
+		EntityQueryHashMap m_entityQueryHashMap;
+		PagedArray<ArchetypeQuery, MAX_CONFIG_ECS_ARCHETYPE_PAGE_SIZE> m_entityQueryRef;
+		ArchetypeQuery     m_entityQueryTemp;
+		uint16_t           m_numEntityQueries;
+
 		MeshQuery m_meshQuery;
-		EntityQuery m_entityQuery;
+		FrameArena m_queryArena;
+		int32_t m_numParallelEach;
+
+		EntityCommandBufferImpl m_entityCommands[MAX_CONFIG_MAX_ENTITY_COMMAND_BUFFERS];
+		bx::HandleAllocT<MAX_CONFIG_MAX_ENTITY_COMMAND_BUFFERS> m_entityCommandsHandle;
+		uint16_t m_entityCommandsQueue[MAX_CONFIG_MAX_ENTITY_COMMAND_BUFFERS];
+		uint16_t m_numEntityCommandsQueued;
+		stl::vector<EntityHandle> m_entityCommandsRemap;
+		bx::Mutex m_entityCommandsLock;
 
 		ViewId m_viewRemap[MAX_CONFIG_MAX_VIEWS];
 		uint32_t m_seq[MAX_CONFIG_MAX_VIEWS];
@@ -8242,6 +10359,61 @@ namespace max
 		RendererContextI* m_renderCtx;
 		PhysicsContextI* m_physicsCtx;
 
+		/// Body transforms before and after last fixed step of batch.
+		struct PhysicsFrame
+		{
+			BodyTransform m_prev[MAX_CONFIG_MAX_BODIES];
+			BodyTransform m_curr[MAX_CONFIG_MAX_BODIES];
+			float m_alpha; //!< Interpolation factor between `m_prev` and `m_curr`.
+		};
+
+		/// Body write issued while fixed step batch is in flight, replayed
+		/// once batch is published.
+		struct PhysicsCommand
+		{
+			enum Enum : uint8_t
+			{
+				SetPosition,
+				SetRotation,
+				SetLinearVelocity,
+				SetAngularVelocity,
+				AddLinearAndAngularVelocity,
+				AddLinearImpulse,
+				AddAngularImpulse,
+				AddBuoyancyImpulse,
+				AddForce,
+				AddTorque,
+				AddMovement,
+				SetFriction,
+
+				Count
+			};
+
+			float      m_data[16];
+			BodyHandle m_handle;
+			uint8_t    m_type;
+			uint8_t    m_activation;
+		};
+
+		typedef stl::vector<PhysicsCommand> PhysicsCommandArray;
+
+		PhysicsFrame m_physicsFrame[2];
+		PhysicsCommandArray m_physicsCommands;
+		uint8_t  m_physicsRead; //!< Index of published physics frame.
+		float    m_physicsStep;
+		float    m_physicsAccumulator;
+		uint32_t m_physicsNumSteps;
+		uint32_t m_physicsMaxSubsteps;
+		uint32_t m_physicsCollisionSteps;
+		bool     m_physicsPending;
+		bool     m_physicsExit;
+		bx::Mutex m_physicsLock; //!< Held by physics thread while stepping, only reads and body creation wait on it.
+#if MAX_CONFIG_MULTITHREADED
+		bx::Semaphore m_physicsKickSem;
+		bx::Semaphore m_physicsDoneSem;
+		bx::Thread    m_physicsThread;
+#endif // MAX_CONFIG_MULTITHREADED
+
 		typedef stl::unordered_map<stl::string, const InputBinding*> InputBindingMap;
 		InputBindingMap m_inputBindingsMap;
 
@@ -14,8 +14,17 @@
 #include <jolt/core/jobsystemthreadpool.h>
 #include <jolt/physics/physicssettings.h>
 #include <jolt/physics/physicssystem.h>
+#include <jolt/physics/staterecorder.h>
+#include <jolt/physics/collision/castresult.h>
+#include <jolt/physics/collision/collisioncollectorimpl.h>
+#include <jolt/physics/collision/raycast.h>
+#include <jolt/physics/collision/shapecast.h>
 #include <jolt/physics/collision/shape/boxshape.h>
 #include <jolt/physics/collision/shape/capsuleshape.h>
+#include <jolt/physics/collision/shape/convexhullshape.h>
+#include <jolt/physics/collision/shape/heightfieldshape.h>
+#include <jolt/physics/collision/shape/meshshape.h>
+#include <jolt/physics/collision/shape/scaledshape.h>
 #include <jolt/physics/collision/shape/sphereshape.h>
 #include <jolt/physics/body/bodycreationsettings.h>
 #include <jolt/physics/body/bodyactivationlistener.h>
@@ -37,9 +46,188 @@ JPH_SUPPRESS_WARNINGS
 
 #include <bx/allocator.h>
 #include <bx/bounds.h>
+#include <bx/cpu.h>
 #include <bx/easing.h>
 #include <bx/rng.h>
 
+namespace max { namespace jolt
+{
+	/// Maximum number of threads with own event buffer, threads above it
+	/// share locked overflow buffer.
+	static constexpr uint32_t kMaxEventThreads = 64;
+
+	static int32_t  s_numEventThreads;
+	static uint32_t s_eventGeneration;
+
+	/// Returns event buffer slot of calling thread. Slot is assigned on first
+	/// event and reassigned after context is recreated.
+	static uint32_t getEventSlot()
+	{
+		static thread_local uint32_t t_slot = UINT32_MAX;
+		static thread_local uint32_t t_generation = UINT32_MAX;
+
+		if (t_generation != s_eventGeneration)
+		{
+			t_slot = uint32_t(bx::atomicFetchAndAdd<int32_t>(&s_numEventThreads, 1) );
+			t_generation = s_eventGeneration;
+		}
+
+		return t_slot;
+	}
+
+	/// Invalidate event buffer slots of all threads, called when context is
+	/// created or destroyed while no Jolt job is running.
+	static void resetEventSlots()
+	{
+		s_numEventThreads = 0;
+		++s_eventGeneration;
+	}
+
+	/// Events written by Jolt from job threads. Each thread appends into its
+	/// own buffer without locking, buffers are merged on physics thread after
+	/// step, and published to game thread at frame start.
+	template<typename Ty>
+	class EventStream
+	{
+	public:
+		///
+		void push(const Ty& _event)
+		{
+			const uint32_t slot = getEventSlot();
+			if (slot < kMaxEventThreads)
+			{
+				m_thread[slot].push_back(_event);
+				return;
+			}
+
+			bx::MutexScope lock(m_overflowLock);
+			m_overflow.push_back(_event);
+		}
+
+		/// Gather per-thread events. Must not be called while Jolt is running
+		/// jobs.
+		void merge()
+		{
+			const uint32_t num = bx::min<uint32_t>(uint32_t(s_numEventThreads), kMaxEventThreads);
+			for (uint32_t ii = 0; ii < num; ++ii)
+			{
+				m_back.insert(m_back.end(), m_thread[ii].begin(), m_thread[ii].end() );
+				m_thread[ii].clear();
+			}
+
+			m_back.insert(m_back.end(), m_overflow.begin(), m_overflow.end() );
+			m_overflow.clear();
+		}
+
+		/// Publish merged events, called while physics thread is idle.
+		void publish()
+		{
+			m_front.swap(m_back);
+			m_back.clear();
+		}
+
+		///
+		const Ty* get(uint32_t* _num) const
+		{
+			*_num = uint32_t(m_front.size() );
+			return m_front.empty() ? NULL : m_front.data();
+		}
+
+		///
+		void reset()
+		{
+			for (uint32_t ii = 0; ii < kMaxEventThreads; ++ii)
+			{
+				m_thread[ii].clear();
+			}
+
+			m_overflow.clear();
+			m_back.clear();
+			m_front.clear();
+		}
+
+	private:
+		stl::vector<Ty> m_thread[kMaxEventThreads];
+		stl::vector<Ty> m_overflow;
+		stl::vector<Ty> m_back;
+		stl::vector<Ty> m_front;
+		bx::Mutex m_overflowLock;
+	};
+
+	static EventStream<ContactEvent>    s_contactEvents;
+	static EventStream<ActivationEvent> s_activationEvents;
+
+	/// Number of contact manifolds added or persisted during step, each one
+	/// is single contact constraint.
+	static int32_t s_numContactConstraints;
+
+	/// Body handle by Jolt body index, used for events where body might be
+	/// already destroyed.
+	static uint16_t s_bodyHandle[MAX_CONFIG_MAX_BODIES];
+
+	static BodyHandle getBodyHandle(const JPH::BodyID& _id)
+	{
+		const uint32_t index = _id.GetIndex();
+		const BodyHandle handle = { index < MAX_CONFIG_MAX_BODIES ? s_bodyHandle[index] : kInvalidHandle };
+		return handle;
+	}
+
+	static void pushContactEvent(ContactState::Enum _state, const JPH::Body& _body0, const JPH::Body& _body1, const JPH::ContactManifold& _manifold)
+	{
+		const JPH::RVec3 position = _manifold.mRelativeContactPointsOn1.empty()
+			? _manifold.mBaseOffset
+			: _manifold.GetWorldSpaceContactPointOn1(0)
+			;
+
+		ContactEvent event;
+		event.m_state      = _state;
+		event.m_body0.idx  = uint16_t(_body0.GetUserData() );
+		event.m_body1.idx  = uint16_t(_body1.GetUserData() );
+		event.m_position   = { float(position.GetX() ), float(position.GetY() ), float(position.GetZ() ) };
+		event.m_normal     = { _manifold.mWorldSpaceNormal.GetX(), _manifold.mWorldSpaceNormal.GetY(), _manifold.mWorldSpaceNormal.GetZ() };
+		event.m_depth      = _manifold.mPenetrationDepth;
+		s_contactEvents.push(event);
+
+		bx::atomicFetchAndAdd<int32_t>(&s_numContactConstraints, 1);
+	}
+
+	/// Temporary allocator that keeps track of peak usage.
+	class TempAllocator final : public JPH::TempAllocator
+	{
+	public:
+		TempAllocator(uint32_t _size)
+			: m_impl(_size)
+			, m_top(0)
+			, m_highWater(0)
+		{
+		}
+
+		virtual void* Allocate(JPH::uint _size) override
+		{
+			m_top += JPH::AlignUp(_size, JPH_RVECTOR_ALIGNMENT);
+			m_highWater = bx::max(m_highWater, m_top);
+			return m_impl.Allocate(_size);
+		}
+
+		virtual void Free(void* _address, JPH::uint _size) override
+		{
+			m_top -= JPH::AlignUp(_size, JPH_RVECTOR_ALIGNMENT);
+			m_impl.Free(_address, _size);
+		}
+
+		uint32_t getHighWater() const
+		{
+			return m_highWater;
+		}
+
+	private:
+		JPH::TempAllocatorImpl m_impl;
+		uint32_t m_top;
+		uint32_t m_highWater;
+	};
+
+} } // namespace max
+
 namespace JPH
 {
 	static void TraceImpl(const char* inFMT, ...)
@@ -60,73 +248,102 @@ namespace JPH
 
 #endif // JPH_ENABLE_ASSERTS
 
+	/// Collects lines and triangles (as wireframe) into single line list,
+	/// submitted with one draw call on flush.
 	class DebugRendererImpl : public JPH::DebugRendererSimple
 	{
 	public:
 		virtual void DrawLine(JPH::RVec3Arg inFrom, JPH::RVec3Arg inTo, JPH::ColorArg inColor) override
 		{
+			addLine(inFrom, inTo, inColor.GetUInt32() );
 		}
 
 		virtual void DrawTriangle(JPH::RVec3Arg inV1, JPH::RVec3Arg inV2, JPH::RVec3Arg inV3, JPH::ColorArg inColor, ECastShadow inCastShadow) override
 		{
-			// @todo Batch together. 
-			max::dbgDrawBegin(0);
-			max::dbgDrawSetColor(0xff00ffff);
-			//max::dbgDrawSetWireframe(true);
-			bx::Triangle triangle;
-			triangle.v0 = { inV1.GetX(), inV1.GetY(), inV1.GetZ() };
-			triangle.v1 = { inV2.GetX(), inV2.GetY(), inV2.GetZ() };
-			triangle.v2 = { inV3.GetX(), inV3.GetY(), inV3.GetZ() };
-			max::dbgDraw(triangle);
-			max::dbgDrawEnd();
+			const uint32_t abgr = inColor.GetUInt32();
+			addLine(inV1, inV2, abgr);
+			addLine(inV2, inV3, abgr);
+			addLine(inV3, inV1, abgr);
 		}
 
 		virtual void DrawText3D(JPH::RVec3Arg inPosition, const string_view& inString, JPH::ColorArg inColor, float inHeight) override
 		{
 		}
+
+		void flush(max::ViewId _viewId)
+		{
+			if (!m_vertices.empty() )
+			{
+				max::dbgDrawLineList(_viewId, m_vertices.data(), uint32_t(m_vertices.size() ) );
+				m_vertices.clear();
+			}
+		}
+
+	private:
+		void addLine(JPH::RVec3Arg _from, JPH::RVec3Arg _to, uint32_t _abgr)
+		{
+			const max::DebugPosVertex from = { float(_from.GetX() ), float(_from.GetY() ), float(_from.GetZ() ), 0.0f, _abgr };
+			const max::DebugPosVertex to   = { float(_to.GetX() ),   float(_to.GetY() ),   float(_to.GetZ() ),   0.0f, _abgr };
+			m_vertices.push_back(from);
+			m_vertices.push_back(to);
+		}
+
+		stl::vector<max::DebugPosVertex> m_vertices;
 	};
 
+	// Object layers map 1:1 to max::LayerType, each object layer has its own
+	// broadphase layer. Layer pairs that don't collide are never tested by
+	// broadphase.
 	namespace Layers
 	{
-		static constexpr ObjectLayer NON_MOVING = 0;
-		static constexpr ObjectLayer MOVING = 1;
-		static constexpr ObjectLayer NUM_LAYERS = 2;
+		static constexpr ObjectLayer NUM_LAYERS = max::LayerType::Count;
+	};
+
+	namespace BroadPhaseLayers
+	{
+		static constexpr uint NUM_LAYERS(max::LayerType::Count);
 	};
 
 	class ObjectLayerPairFilterImpl : public ObjectLayerPairFilter
 	{
 	public:
-		virtual bool ShouldCollide(ObjectLayer inObject1, ObjectLayer inObject2) const override
+		ObjectLayerPairFilterImpl()
 		{
-			switch (inObject1)
+			for (uint ii = 0; ii < Layers::NUM_LAYERS; ++ii)
 			{
-			case Layers::NON_MOVING:
-				return inObject2 == Layers::MOVING; // Non moving only collides with moving
-			case Layers::MOVING:
-				return true; // Moving collides with everything
-			default:
-				JPH_ASSERT(false);
-				return false;
+				mMask[ii] = 0xff;
 			}
 		}
-	};
 
-	namespace BroadPhaseLayers
-	{
-		static constexpr BroadPhaseLayer NON_MOVING(0);
-		static constexpr BroadPhaseLayer MOVING(1);
-		static constexpr uint NUM_LAYERS(2);
+		/// Set collision mask per layer, mask is made symmetric.
+		void Init(const uint8 *inMask)
+		{
+			for (uint ii = 0; ii < Layers::NUM_LAYERS; ++ii)
+			{
+				mMask[ii] = inMask[ii];
+
+				for (uint jj = 0; jj < Layers::NUM_LAYERS; ++jj)
+				{
+					if (0 != (inMask[jj] & (1<<ii) ) )
+					{
+						mMask[ii] |= uint8(1<<jj);
+					}
+				}
+			}
+		}
+
+		virtual bool ShouldCollide(ObjectLayer inObject1, ObjectLayer inObject2) const override
+		{
+			JPH_ASSERT(inObject1 < Layers::NUM_LAYERS && inObject2 < Layers::NUM_LAYERS);
+			return 0 != (mMask[inObject1] & (1<<inObject2) );
+		}
+
+		uint8							mMask[Layers::NUM_LAYERS];
 	};
 
 	class BPLayerInterfaceImpl final : public BroadPhaseLayerInterface
 	{
 	public:
-		BPLayerInterfaceImpl()
-		{
-			mObjectToBroadPhase[Layers::NON_MOVING] = BroadPhaseLayers::NON_MOVING;
-			mObjectToBroadPhase[Layers::MOVING] = BroadPhaseLayers::MOVING;
-		}
-
 		virtual uint GetNumBroadPhaseLayers() const override
 		{
 			return BroadPhaseLayers::NUM_LAYERS;
@@ -135,7 +352,7 @@ namespace JPH
 		virtual BroadPhaseLayer GetBroadPhaseLayer(ObjectLayer inLayer) const override
 		{
 			JPH_ASSERT(inLayer < Layers::NUM_LAYERS);
-			return mObjectToBroadPhase[inLayer];
+			return BroadPhaseLayer(BroadPhaseLayer::Type(inLayer) );
 		}
 
 #if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
@@ -143,33 +360,31 @@ namespace JPH
 		{
 			switch ((BroadPhaseLayer::Type)inLayer)
 			{
-			case (BroadPhaseLayer::Type)BroadPhaseLayers::NON_MOVING:	return "NON_MOVING";
-			case (BroadPhaseLayer::Type)BroadPhaseLayers::MOVING:		return "MOVING";
-			default:													JPH_ASSERT(false); return "INVALID";
+			case max::LayerType::NonMoving:	return "NON_MOVING";
+			case max::LayerType::Moving:	return "MOVING";
+			case max::LayerType::Debris:	return "DEBRIS";
+			case max::LayerType::Trigger:	return "TRIGGER";
+			default:						JPH_ASSERT(false); return "INVALID";
 			}
 		}
 #endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
-
-	private:
-		BroadPhaseLayer					mObjectToBroadPhase[Layers::NUM_LAYERS];
 	};
 
 	class ObjectVsBroadPhaseLayerFilterImpl : public ObjectVsBroadPhaseLayerFilter
 	{
 	public:
+		ObjectVsBroadPhaseLayerFilterImpl(const ObjectLayerPairFilterImpl& inPairFilter)
+			: mPairFilter(inPairFilter)
+		{
+		}
+
 		virtual bool ShouldCollide(ObjectLayer inLayer1, BroadPhaseLayer inLayer2) const override
 		{
-			switch (inLayer1)
-			{
-			case Layers::NON_MOVING:
-				return inLayer2 == BroadPhaseLayers::MOVING;
-			case Layers::MOVING:
-				return true;
-			default:
-				JPH_ASSERT(false);
-				return false;
-			}
+			return mPairFilter.ShouldCollide(inLayer1, ObjectLayer( (BroadPhaseLayer::Type)inLayer2) );
 		}
+
+	private:
+		const ObjectLayerPairFilterImpl& mPairFilter;
 	};
 
 	class MyContactListener : public ContactListener
@@ -182,14 +397,22 @@ namespace JPH
 
 		virtual void OnContactAdded(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, ContactSettings& ioSettings) override
 		{
+			max::jolt::pushContactEvent(max::ContactState::Added, inBody1, inBody2, inManifold);
 		}
 
 		virtual void OnContactPersisted(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, ContactSettings& ioSettings) override
 		{
+			max::jolt::pushContactEvent(max::ContactState::Persisted, inBody1, inBody2, inManifold);
 		}
 
 		virtual void OnContactRemoved(const SubShapeIDPair& inSubShapePair) override
 		{
+			// Bodies might be destroyed already, don't touch them.
+			max::ContactEvent event;
+			event.m_state = max::ContactState::Removed;
+			event.m_body0 = max::jolt::getBodyHandle(inSubShapePair.GetBody1ID() );
+			event.m_body1 = max::jolt::getBodyHandle(inSubShapePair.GetBody2ID() );
+			max::jolt::s_contactEvents.push(event);
 		}
 	};
 
@@ -198,10 +421,18 @@ namespace JPH
 	public:
 		virtual void OnBodyActivated(const BodyID& inBodyID, uint64 inBodyUserData) override
 		{
+			max::ActivationEvent event;
+			event.m_body.idx = uint16_t(inBodyUserData);
+			event.m_active   = true;
+			max::jolt::s_activationEvents.push(event);
 		}
 
 		virtual void OnBodyDeactivated(const BodyID& inBodyID, uint64 inBodyUserData) override
 		{
+			max::ActivationEvent event;
+			event.m_body.idx = uint16_t(inBodyUserData);
+			event.m_active   = false;
+			max::jolt::s_activationEvents.push(event);
 		}
 	};
 
@@ -260,13 +491,261 @@ namespace max { namespace jolt
 
 	static JPH::PhysicsSystem* s_system;
 
+	/// Relative distance under which vertex coordinates are on same grid line.
+	static constexpr float kHeightFieldEpsilon = 1.0e-4f;
+
+	/// Sort coordinates and collapse ones closer than `_epsilon`, returns
+	/// number of distinct coordinates.
+	static uint32_t heightFieldCoords(float* _coords, uint32_t _num, float _epsilon)
+	{
+		bx::quickSort(_coords, _num, bx::compareAscending<float>);
+
+		uint32_t num = 0;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			if (0 == num
+			||  _coords[ii] - _coords[num - 1] > _epsilon)
+			{
+				_coords[num++] = _coords[ii];
+			}
+		}
+
+		return num;
+	}
+
+	/// Find index of distinct coordinate nearest to `_value`.
+	static uint32_t heightFieldFind(const float* _coords, uint32_t _num, float _value)
+	{
+		uint32_t lo = 0;
+		uint32_t hi = _num - 1;
+		while (lo < hi)
+		{
+			const uint32_t mid = (lo + hi) / 2;
+			if (_coords[mid] < _value)
+			{
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+
+		return 0 < lo && _value - _coords[lo - 1] < _coords[lo] - _value
+			? lo - 1
+			: lo
+			;
+	}
+
+	struct HeightFieldLerp
+	{
+		uint32_t m_idx; //!< First of two source grid lines.
+		float    m_t;   //!< Interpolation factor between them.
+	};
+
+	/// Find source grid lines surrounding each of `_num` uniformly spaced samples.
+	static void heightFieldLerp(HeightFieldLerp* _out, uint32_t _num, const float* _coords, uint32_t _numCoords, float _min, float _scale)
+	{
+		uint32_t idx = 0;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			const float pos = _min + float(ii) * _scale;
+			while (idx + 2 < _numCoords
+			&&     _coords[idx + 1] < pos)
+			{
+				++idx;
+			}
+
+			const float width = _coords[idx + 1] - _coords[idx];
+			_out[ii].m_idx = idx;
+			_out[ii].m_t   = bx::clamp( (pos - _coords[idx]) / width, 0.0f, 1.0f);
+		}
+	}
+
+	/// Build collision shape from RAM copy of mesh vertices and indices.
+	static JPH::Ref<JPH::Shape> createMeshShape(CollisionShape::Enum _shape, const MeshRef& _mesh)
+	{
+		uint32_t numVertices = 0;
+		for (GroupArray::const_iterator it = _mesh.m_groups.begin(), itEnd = _mesh.m_groups.end(); it != itEnd; ++it)
+		{
+			numVertices += it->m_numVertices;
+		}
+
+		JPH::VertexList vertices;
+		vertices.reserve(numVertices);
+
+		JPH::IndexedTriangleList triangles;
+
+		for (GroupArray::const_iterator it = _mesh.m_groups.begin(), itEnd = _mesh.m_groups.end(); it != itEnd; ++it)
+		{
+			const Group& group = *it;
+			const uint32_t base = uint32_t(vertices.size() );
+
+			for (uint32_t ii = 0; ii < group.m_numVertices; ++ii)
+			{
+				float pos[4];
+				vertexUnpack(pos, Attrib::Position, _mesh.m_layout, group.m_vertices, ii);
+				vertices.push_back(JPH::Float3(pos[0], pos[1], pos[2]) );
+			}
+
+			if (CollisionShape::Mesh == _shape)
+			{
+				for (uint32_t ii = 0; ii + 2 < group.m_numIndices; ii += 3)
+				{
+					triangles.push_back(JPH::IndexedTriangle(
+						  base + group.m_indices[ii + 0]
+						, base + group.m_indices[ii + 1]
+						, base + group.m_indices[ii + 2]
+						, 0
+						) );
+				}
+			}
+		}
+
+		JPH::ShapeSettings::ShapeResult result;
+
+		switch (_shape)
+		{
+		case CollisionShape::Mesh:
+			{
+				JPH::MeshShapeSettings settings(vertices, triangles);
+				result = settings.Create();
+			}
+			break;
+
+		case CollisionShape::ConvexHull:
+			{
+				JPH::Array<JPH::Vec3> points;
+				points.reserve(vertices.size() );
+				for (const JPH::Float3& vertex : vertices)
+				{
+					points.push_back(JPH::Vec3(vertex) );
+				}
+
+				JPH::ConvexHullShapeSettings settings(points);
+				result = settings.Create();
+			}
+			break;
+
+		case CollisionShape::HeightField:
+			{
+				// Mesh is expected to be grid (terrain), grid lines are found
+				// from distinct vertex X and Z positions.
+				float min[2] = {  FLT_MAX,  FLT_MAX };
+				float max[2] = { -FLT_MAX, -FLT_MAX };
+
+				JPH::Array<float> coordX;
+				JPH::Array<float> coordZ;
+				coordX.reserve(vertices.size() );
+				coordZ.reserve(vertices.size() );
+
+				for (const JPH::Float3& vertex : vertices)
+				{
+					min[0] = bx::min(min[0], vertex.x);
+					min[1] = bx::min(min[1], vertex.z);
+					max[0] = bx::max(max[0], vertex.x);
+					max[1] = bx::max(max[1], vertex.z);
+					coordX.push_back(vertex.x);
+					coordZ.push_back(vertex.z);
+				}
+
+				const uint32_t numX = heightFieldCoords(coordX.data(), uint32_t(coordX.size() ), (max[0] - min[0]) * kHeightFieldEpsilon);
+				const uint32_t numZ = heightFieldCoords(coordZ.data(), uint32_t(coordZ.size() ), (max[1] - min[1]) * kHeightFieldEpsilon);
+
+				if (2 > numX
+				||  2 > numZ)
+				{
+					BX_TRACE("Height field mesh has no extent in XZ plane.");
+					return NULL;
+				}
+
+				JPH::Array<float> grid;
+				grid.resize(numX*numZ, JPH::HeightFieldShapeConstants::cNoCollisionValue);
+
+				for (const JPH::Float3& vertex : vertices)
+				{
+					const uint32_t xx = heightFieldFind(coordX.data(), numX, vertex.x);
+					const uint32_t zz = heightFieldFind(coordZ.data(), numZ, vertex.z);
+
+					float& sample = grid[zz*numX + xx];
+					sample = sample == JPH::HeightFieldShapeConstants::cNoCollisionValue
+						? vertex.y
+						: bx::max(sample, vertex.y)
+						;
+				}
+
+				for (float sample : grid)
+				{
+					if (sample == JPH::HeightFieldShapeConstants::cNoCollisionValue)
+					{
+						BX_TRACE("Height field mesh is not regular grid (%d x %d).", numX, numZ);
+						return NULL;
+					}
+				}
+
+				// Resample grid into square grid expected by Jolt.
+				const uint32_t sampleCount = bx::max<uint32_t>(4, bx::max(numX, numZ) );
+				const float scaleX = (max[0] - min[0]) / float(sampleCount - 1);
+				const float scaleZ = (max[1] - min[1]) / float(sampleCount - 1);
+
+				JPH::Array<HeightFieldLerp> lerpX;
+				JPH::Array<HeightFieldLerp> lerpZ;
+				lerpX.resize(sampleCount);
+				lerpZ.resize(sampleCount);
+				heightFieldLerp(lerpX.data(), sampleCount, coordX.data(), numX, min[0], scaleX);
+				heightFieldLerp(lerpZ.data(), sampleCount, coordZ.data(), numZ, min[1], scaleZ);
+
+				JPH::Array<float> samples;
+				samples.resize(sampleCount*sampleCount);
+
+				for (uint32_t zz = 0; zz < sampleCount; ++zz)
+				{
+					const HeightFieldLerp& lz = lerpZ[zz];
+					const float* row0 = &grid[ lz.m_idx     *numX];
+					const float* row1 = &grid[(lz.m_idx + 1)*numX];
+
+					for (uint32_t xx = 0; xx < sampleCount; ++xx)
+					{
+						const HeightFieldLerp& lx = lerpX[xx];
+						const float y0 = bx::lerp(row0[lx.m_idx], row0[lx.m_idx + 1], lx.m_t);
+						const float y1 = bx::lerp(row1[lx.m_idx], row1[lx.m_idx + 1], lx.m_t);
+						samples[zz*sampleCount + xx] = bx::lerp(y0, y1, lz.m_t);
+					}
+				}
+
+				JPH::HeightFieldShapeSettings settings(
+					  samples.data()
+					, JPH::Vec3(min[0], 0.0f, min[1])
+					, JPH::Vec3(scaleX, 1.0f, scaleZ)
+					, sampleCount
+					);
+				result = settings.Create();
+			}
+			break;
+
+		default:
+			BX_ASSERT(false, "Shape %d can't be created from mesh.", _shape);
+			break;
+		}
+
+		if (result.IsValid() )
+		{
+			return result.Get();
+		}
+
+		BX_TRACE("Failed to create collision shape from mesh: %s", result.HasError() ? result.GetError().c_str() : "");
+		return NULL;
+	}
+
 	struct BodyRef
 	{
 		BodyRef()
 			: m_id(JPH::BodyID::cInvalidBodyID)
+			, m_shapeKey(0)
+			, m_groundQuery(false)
 		{}
 
-		JPH::Ref<JPH::Shape> createShape(CollisionShape::Enum shape, const bx::Vec3& pos, const bx::Quaternion& quat, const bx::Vec3& scale)
+		static JPH::Ref<JPH::Shape> createShape(CollisionShape::Enum shape, const bx::Vec3& pos, const bx::Quaternion& quat, const bx::Vec3& scale)
 		{
 			JPH::ShapeSettings::ShapeResult result;
 
@@ -300,11 +779,12 @@ namespace max { namespace jolt
 			return NULL;
 		}
 
-		void create(CollisionShape::Enum _shape, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags)
+		bool create(BodyHandle _handle, const JPH::Ref<JPH::Shape>& _shape, uint64_t _shapeKey, const bx::Vec3& _pos, const bx::Quaternion& _quat, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags)
 		{
 			JPH::BodyInterface& bodyInterface = s_system->GetBodyInterface();
 
-			m_shape = createShape(_shape, _pos, _quat, _scale);
+			m_shape = _shape;
+			m_shapeKey = _shapeKey;
 
 			m_layer = _layer;
 
@@ -316,11 +796,26 @@ namespace max { namespace jolt
 				(uint16_t)m_layer
 			);
 
-			settings.mAllowedDOFs = (JPH::EAllowedDOFs)_flags;
+			settings.mAllowedDOFs = (JPH::EAllowedDOFs)(_flags & MAX_BODY_ALLOW_ALL);
+			settings.mUserData = _handle.idx;
+			settings.mIsSensor = LayerType::Trigger == m_layer;
 			//settings.mGravityFactor = 2.0f;
 			//settings.mMaxLinearVelocity = _maxVelocity; @todo Let's not expose this?
 
 			m_id = bodyInterface.CreateAndAddBody(settings, (JPH::EActivation)_activation);
+			if (m_id.IsInvalid() )
+			{
+				BX_TRACE("Failed to create body, Jolt body limit reached.");
+				m_shape = NULL;
+				m_shapeKey = 0;
+				return false;
+			}
+
+			s_bodyHandle[m_id.GetIndex()] = _handle.idx;
+			m_groundQuery = 0 != (_flags & MAX_BODY_GROUND_QUERY);
+			m_ground = GroundInfo();
+
+			return true;
 		}
 
 		void destroy()
@@ -328,6 +823,10 @@ namespace max { namespace jolt
 			JPH::BodyInterface& bodyInterface = s_system->GetBodyInterface();
 			bodyInterface.RemoveBody(m_id);
 			bodyInterface.DestroyBody(m_id);
+			m_id = JPH::BodyID();
+			m_shape = NULL;
+			m_shapeKey = 0;
+			m_groundQuery = false;
 		}
 
 		void checkCollision(JPH::RMat44Arg inCenterOfMassTransform, JPH::Vec3Arg inMovementDirection, JPH::RVec3Arg inBaseOffset, JPH::CollideShapeCollector& ioCollector) const
@@ -351,13 +850,15 @@ namespace max { namespace jolt
 			checkCollision(center_of_mass, inMovementDirection, inBaseOffset, ioCollector);
 		}
 
-		void simulate()
+		/// Evaluate ground state. Called from Jolt job threads after step,
+		/// bodies are not written to at this point so no locking is needed.
+		void updateGround()
 		{
 			JPH::RVec3 char_pos;
 			JPH::Quat char_rot;
 			JPH::Vec3 char_vel;
 			{
-				JPH::BodyLockRead lock(s_system->GetBodyLockInterface(), m_id);
+				JPH::BodyLockRead lock(s_system->GetBodyLockInterfaceNoLock(), m_id);
 				if (!lock.Succeeded())
 				{
 					return;
@@ -378,7 +879,7 @@ namespace max { namespace jolt
 			info.m_position = fromVec(collector.mGroundPosition);
 			info.m_normal = fromVec(collector.mGroundNormal);
 
-			JPH::BodyLockRead lock(s_system->GetBodyLockInterface(), collector.mGroundBodyID);
+			JPH::BodyLockRead lock(s_system->GetBodyLockInterfaceNoLock(), collector.mGroundBodyID);
 			if (lock.Succeeded())
 			{
 				const JPH::Body& body = lock.GetBody();
@@ -520,6 +1021,9 @@ namespace max { namespace jolt
 		/// 
 		JPH::Ref<JPH::Shape> m_shape;
 
+		/// Key of cached mesh shape, zero for primitive shapes.
+		uint64_t m_shapeKey;
+
 		/// 
 		LayerType::Enum m_layer;
 
@@ -536,6 +1040,9 @@ namespace max { namespace jolt
 
 		/// 
 		GroundInfo m_ground;
+
+		/// Evaluate ground state after each step, see `MAX_BODY_GROUND_QUERY`.
+		bool m_groundQuery;
 	};
 
 	struct PhysicsContextJolt : public PhysicsContextI
@@ -543,7 +1050,10 @@ namespace max { namespace jolt
 		PhysicsContextJolt()
 			: m_allocator(NULL)
 			, m_jobSystem(NULL)
-		{}
+			, m_ovbplf(m_olpf)
+		{
+			bx::memSet(m_stats, 0, sizeof(m_stats) );
+		}
 
 		~PhysicsContextJolt()
 		{}
@@ -560,25 +1070,34 @@ namespace max { namespace jolt
 
 			JPH::RegisterTypes();
 
-			m_allocator = new JPH::TempAllocatorImpl(10 * 1024 * 1024);
-			m_jobSystem = new JPH::JobSystemThreadPool(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, std::thread::hardware_concurrency() - 1);
+			const Init::Physics& physics = _init.physics;
+
+			resetEventSlots();
+
+			m_allocator = new TempAllocator(physics.tempAllocatorSize);
+			m_jobSystem = new JPH::JobSystemThreadPool(
+				  JPH::cMaxPhysicsJobs
+				, JPH::cMaxPhysicsBarriers
+				, UINT8_MAX == physics.numThreads ? -1 : int(physics.numThreads)
+				);
+
+			m_olpf.Init(physics.layerMask);
 
-			// @todo Make max::Init settings for physics.
 			s_system = new JPH::PhysicsSystem();
 			s_system->Init(
-				MAX_CONFIG_MAX_BODIES,
-				0, // @todo
-				MAX_CONFIG_MAX_BODY_PAIRS,
-				MAX_CONFIG_MAX_CONTACT_CONSTRAINTS,
-				m_bpli,
-				m_ovbplf,
-				m_olpf
-			);
+				  physics.maxBodies
+				, physics.numBodyMutexes
+				, physics.maxBodyPairs
+				, physics.maxContactConstraints
+				, m_bpli
+				, m_ovbplf
+				, m_olpf
+				);
 
 			s_system->SetBodyActivationListener(&m_bodyActivationListener);
 			s_system->SetContactListener(&m_contactListener);
 
-			s_system->SetGravity(JPH::Vec3(0.0f, -10.0f, 0.0f));
+			s_system->SetGravity(JPH::Vec3(physics.gravity[0], physics.gravity[1], physics.gravity[2]) );
 
 			s_system->OptimizeBroadPhase();
 
@@ -587,6 +1106,12 @@ namespace max { namespace jolt
 
 		void shutdown()
 		{
+			m_shapeCache.clear();
+			m_stateBuffer.clear();
+
+			s_contactEvents.reset();
+			s_activationEvents.reset();
+
 			JPH::UnregisterTypes();
 
 			delete JPH::Factory::sInstance;
@@ -594,6 +1119,8 @@ namespace max { namespace jolt
 			delete m_allocator;
 			delete m_jobSystem;
 			delete s_system;
+
+			resetEventSlots();
 		}
 
 		PhysicsType::Enum getPhysicsType() const override
@@ -606,38 +1133,410 @@ namespace max { namespace jolt
 			return MAX_PHYSICS_JOLT_NAME;
 		}
 
-		void simulate(const float _dt) override
+		void simulate(const float _dt, uint32_t _collisionSteps) override
 		{
+			const int64_t timeBegin = bx::getHPCounter();
+
+			s_numContactConstraints = 0;
+
 			// Main simulaton
-			int collisionSteps = 1;
-			JPH::EPhysicsUpdateError err = s_system->Update(_dt, collisionSteps, m_allocator, m_jobSystem);
-			BX_ASSERT(err == JPH::EPhysicsUpdateError::None, "Error updating physics system.");
+			const JPH::EPhysicsUpdateError err = s_system->Update(_dt, int(_collisionSteps), m_allocator, m_jobSystem);
+			BX_WARN(err == JPH::EPhysicsUpdateError::None, "Physics update error 0x%x, increase physics limits in max::Init.", uint32_t(err) );
+
+			s_contactEvents.merge();
+			s_activationEvents.merge();
+
+			const int64_t timeGround = bx::getHPCounter();
+			updateGround();
+			const int64_t timeEnd = bx::getHPCounter();
+
+			PhysicsStats& stats = m_stats[1];
+			stats.cpuTimeStep   += timeEnd - timeBegin;
+			stats.cpuTimeGround += timeEnd - timeGround;
+			stats.numSteps      += 1;
+			stats.numBodies              = s_system->GetNumBodies();
+			stats.numActiveBodies        = s_system->GetNumActiveBodies(JPH::EBodyType::RigidBody);
+			stats.numContactConstraints  = uint32_t(s_numContactConstraints);
+			stats.tempAllocatorHighWater = m_allocator->getHighWater();
+			stats.bodyPairsFull          |= 0 != (uint32_t(err) & uint32_t(JPH::EPhysicsUpdateError::BodyPairCacheFull) );
+			stats.contactConstraintsFull |= 0 != (uint32_t(err) & uint32_t(JPH::EPhysicsUpdateError::ManifoldCacheFull | JPH::EPhysicsUpdateError::ContactConstraintsFull) );
+		}
+
+		/// Evaluate ground state of active bodies that opted in, spread across
+		/// Jolt job system.
+		void updateGround()
+		{
+			const JPH::BodyInterface& bodyInterface = s_system->GetBodyInterfaceNoLock();
+
+			const uint32_t numActive = s_system->GetNumActiveBodies(JPH::EBodyType::RigidBody);
+			const JPH::BodyID* active = s_system->GetActiveBodiesUnsafe(JPH::EBodyType::RigidBody);
+
+			uint32_t num = 0;
+			for (uint32_t ii = 0; ii < numActive; ++ii)
+			{
+				const uint16_t idx = uint16_t(bodyInterface.GetUserData(active[ii]) );
+				if (m_bodies[idx].m_groundQuery)
+				{
+					m_groundQuery[num++] = idx;
+				}
+			}
+
+			parallelFor("max - Ground", num, 16, [this](uint32_t _begin, uint32_t _end)
+			{
+				for (uint32_t ii = _begin; ii < _end; ++ii)
+				{
+					m_bodies[m_groundQuery[ii] ].updateGround();
+				}
+			});
+		}
+
+		/// Split `_num` items into ranges of at least `_grain` items and run
+		/// them on Jolt job system, blocks until all ranges are done.
+		template<typename Fn>
+		void parallelFor(const char* _name, uint32_t _num, uint32_t _grain, const Fn& _fn)
+		{
+			const uint32_t numJobs = bx::min<uint32_t>( (_num + _grain - 1) / _grain, uint32_t(m_jobSystem->GetMaxConcurrency() ) );
+
+			if (1 >= numJobs)
+			{
+				_fn(0, _num);
+				return;
+			}
+
+			JPH::JobSystem::Barrier* barrier = m_jobSystem->CreateBarrier();
+
+			const uint32_t step = _num / numJobs;
+			const uint32_t rest = _num % numJobs;
+
+			uint32_t begin = 0;
+			for (uint32_t ii = 0; ii < numJobs; ++ii)
+			{
+				const uint32_t end = begin + step + (ii < rest ? 1 : 0);
+
+				JPH::JobHandle job = m_jobSystem->CreateJob(_name, JPH::Color::sGreen, [&_fn, begin, end]()
+				{
+					_fn(begin, end);
+				});
+				barrier->AddJob(job);
+
+				begin = end;
+			}
+
+			m_jobSystem->WaitForJobs(barrier);
+			m_jobSystem->DestroyBarrier(barrier);
+		}
+
+		// Queries are called with physics lock held, physics thread is not
+		// stepping so no-lock query interface is used.
+
+		static BodyHandle toBodyHandle(const JPH::BodyID& _id)
+		{
+			const BodyHandle handle = { uint16_t(s_system->GetBodyInterfaceNoLock().GetUserData(_id) ) };
+			return handle;
+		}
+
+		static bx::Vec3 getSurfaceNormal(const JPH::BodyID& _id, const JPH::SubShapeID& _subShapeId, JPH::RVec3Arg _position)
+		{
+			JPH::BodyLockRead lock(s_system->GetBodyLockInterfaceNoLock(), _id);
+			if (lock.Succeeded() )
+			{
+				return fromVec(lock.GetBody().GetWorldSpaceSurfaceNormal(_subShapeId, _position) );
+			}
+
+			return { 0.0f, 0.0f, 0.0f };
+		}
+
+		void rayCast(const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits) override
+		{
+			parallelFor("max - Ray cast", _num, 64, [_rays, _hits](uint32_t _begin, uint32_t _end)
+			{
+				const JPH::NarrowPhaseQuery& query = s_system->GetNarrowPhaseQueryNoLock();
+
+				for (uint32_t ii = _begin; ii < _end; ++ii)
+				{
+					const JPH::RRayCast ray(toVec(_rays[ii].m_origin), toVec(_rays[ii].m_direction) );
+
+					PhysicsHit& hit = _hits[ii];
+					hit = PhysicsHit();
+
+					JPH::RayCastResult result;
+					if (query.CastRay(ray, result) )
+					{
+						const JPH::RVec3 position = ray.GetPointOnRay(result.mFraction);
+
+						hit.m_body     = toBodyHandle(result.mBodyID);
+						hit.m_fraction = result.mFraction;
+						hit.m_position = fromVec(position);
+						hit.m_normal   = getSurfaceNormal(result.mBodyID, result.mSubShapeID2, position);
+					}
+				}
+			});
+		}
+
+		void shapeCast(CollisionShape::Enum _shape, const bx::Vec3& _scale, const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits) override
+		{
+			const JPH::Ref<JPH::Shape> shape = BodyRef::createShape(_shape, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, _scale);
+			if (NULL == shape)
+			{
+				return;
+			}
+
+			const JPH::Shape* shapePtr = shape.GetPtr();
+
+			parallelFor("max - Shape cast", _num, 16, [shapePtr, _rays, _hits](uint32_t _begin, uint32_t _end)
+			{
+				const JPH::NarrowPhaseQuery& query = s_system->GetNarrowPhaseQueryNoLock();
+
+				const JPH::ShapeCastSettings settings;
+
+				for (uint32_t ii = _begin; ii < _end; ++ii)
+				{
+					const JPH::RVec3 origin = toVec(_rays[ii].m_origin);
+					const JPH::RShapeCast cast(
+						  shapePtr
+						, JPH::Vec3::sReplicate(1.0f)
+						, JPH::RMat44::sTranslation(origin)
+						, toVec(_rays[ii].m_direction)
+						);
+
+					PhysicsHit& hit = _hits[ii];
+					hit = PhysicsHit();
+
+					JPH::ClosestHitCollisionCollector<JPH::CastShapeCollector> collector;
+					query.CastShape(cast, settings, origin, collector);
+
+					if (collector.HadHit() )
+					{
+						const JPH::ShapeCastResult& result = collector.mHit;
+						const JPH::RVec3 position = origin + result.mContactPointOn2;
+
+						hit.m_body     = toBodyHandle(result.mBodyID2);
+						hit.m_fraction = result.mFraction;
+						hit.m_position = fromVec(position);
+						hit.m_normal   = fromVec(-result.mPenetrationAxis.NormalizedOr(JPH::Vec3::sZero() ) );
+					}
+				}
+			});
+		}
+
+		/// Collects unique bodies overlapping shape.
+		class OverlapCollector : public JPH::CollideShapeCollector
+		{
+		public:
+			OverlapCollector(BodyHandle* _bodies, uint32_t _max)
+				: m_bodies(_bodies)
+				, m_max(_max)
+				, m_num(0)
+			{
+			}
+
+			virtual void AddHit(const JPH::CollideShapeResult& _result) override
+			{
+				const BodyHandle handle = toBodyHandle(_result.mBodyID2);
+
+				for (uint32_t ii = 0; ii < m_num; ++ii)
+				{
+					if (m_bodies[ii].idx == handle.idx)
+					{
+						return;
+					}
+				}
+
+				m_bodies[m_num++] = handle;
+
+				if (m_num == m_max)
+				{
+					ForceEarlyOut();
+				}
+			}
+
+			BodyHandle* m_bodies;
+			uint32_t m_max;
+			uint32_t m_num;
+		};
+
+		void overlap(CollisionShape::Enum _shape, const bx::Vec3& _scale, const bx::Vec3* _positions, uint32_t _num, BodyHandle* _bodies, uint32_t _maxBodies, uint32_t* _numBodies) override
+		{
+			const JPH::Ref<JPH::Shape> shape = BodyRef::createShape(_shape, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, _scale);
+			if (NULL == shape
+			||  0 == _maxBodies)
+			{
+				bx::memSet(_numBodies, 0, _num*sizeof(uint32_t) );
+				return;
+			}
+
+			const JPH::Shape* shapePtr = shape.GetPtr();
+
+			parallelFor("max - Overlap", _num, 16, [shapePtr, _positions, _bodies, _maxBodies, _numBodies](uint32_t _begin, uint32_t _end)
+			{
+				const JPH::NarrowPhaseQuery& query = s_system->GetNarrowPhaseQueryNoLock();
+
+				const JPH::CollideShapeSettings settings;
+
+				for (uint32_t ii = _begin; ii < _end; ++ii)
+				{
+					const JPH::RVec3 position = toVec(_positions[ii]);
+
+					OverlapCollector collector(&_bodies[ii*_maxBodies], _maxBodies);
+					query.CollideShape(
+						  shapePtr
+						, JPH::Vec3::sReplicate(1.0f)
+						, JPH::RMat44::sTranslation(position)
+						, settings
+						, position
+						, collector
+						);
+
+					_numBodies[ii] = collector.m_num;
+				}
+			});
+		}
+
+		void getBodyTransforms(BodyTransform* _transforms) override
+		{
+			// Called from physics thread between steps, no other thread is
+			// touching physics world.
+			const JPH::BodyInterface& bodyInterface = s_system->GetBodyInterfaceNoLock();
 
-			// Post simulation on bodies.
 			for (uint32_t ii = 0; ii < MAX_CONFIG_MAX_BODIES; ++ii)
 			{
-				BodyRef& br = m_bodies[ii];
+				const BodyRef& br = m_bodies[ii];
 				if (br.m_id.IsInvalid())
 				{
-					break;
+					continue;
 				}
 
-				br.simulate();
+				JPH::RVec3 pos;
+				JPH::Quat rot;
+				bodyInterface.GetPositionAndRotation(br.m_id, pos, rot);
+
+				bx::store(_transforms[ii].m_pos, fromVec(pos) );
+				bx::store(_transforms[ii].m_rot, fromQuat(rot) );
 			}
+		}
+
+		void publishEvents() override
+		{
+			// Activation events can be generated outside of step by body API,
+			// those are picked up here.
+			s_activationEvents.merge();
+
+			s_contactEvents.publish();
+			s_activationEvents.publish();
+
+			// Stats are published together with events, counts are kept when
+			// there were no steps.
+			m_stats[0] = m_stats[1];
+			m_stats[0].numBodies       = s_system->GetNumBodies();
+			m_stats[0].numActiveBodies = s_system->GetNumActiveBodies(JPH::EBodyType::RigidBody);
+
+			m_stats[1].cpuTimeStep   = 0;
+			m_stats[1].cpuTimeGround = 0;
+			m_stats[1].numSteps      = 0;
+			m_stats[1].numContactConstraints  = 0;
+			m_stats[1].bodyPairsFull          = false;
+			m_stats[1].contactConstraintsFull = false;
+		}
+
+		void getStats(PhysicsStats& _stats) override
+		{
+			_stats = m_stats[0];
+		}
+
+		const ContactEvent* getContactEvents(uint32_t* _num) override
+		{
+			return s_contactEvents.get(_num);
+		}
+
+		const ActivationEvent* getActivationEvents(uint32_t* _num) override
+		{
+			return s_activationEvents.get(_num);
+		}
+
+		void debugDraw(ViewId _viewId) override
+		{
+			JPH::DebugRendererImpl* renderer = static_cast<JPH::DebugRendererImpl*>(JPH::DebugRenderer::sInstance);
 
-			// @todo Check for MAX_DEBUG_PHYSICS
 			JPH::BodyManager::DrawSettings settings;
-			s_system->DrawBodies(settings, JPH::DebugRenderer::sInstance);
+			s_system->DrawBodies(settings, renderer);
+
+			renderer->flush(_viewId);
 		}
 
 		void createBody(BodyHandle _handle, CollisionShape::Enum _shape, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags) override
 		{
-			m_bodies[_handle.idx].create(_shape, _pos, _quat, _scale, _layer, _motion, _activation, _maxVelocity, _flags);
+			BodyRef& br = m_bodies[_handle.idx];
+			br.create(_handle, br.createShape(_shape, _pos, _quat, _scale), 0, _pos, _quat, _layer, _motion, _activation, _maxVelocity, _flags);
+		}
+
+		bool createMeshBody(BodyHandle _handle, CollisionShape::Enum _shape, const MeshRef& _mesh, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags) override
+		{
+			// Mesh without content hash (not yet loaded) is never cached.
+			const uint64_t key = 0 == _mesh.m_hash
+				? 0
+				: (uint64_t(_mesh.m_hash) << 32) | uint64_t(_shape)
+				;
+
+			JPH::Ref<JPH::Shape> shape;
+
+			ShapeCache::iterator it = 0 == key ? m_shapeCache.end() : m_shapeCache.find(key);
+			if (it != m_shapeCache.end() )
+			{
+				shape = it->second;
+			}
+			else
+			{
+				shape = createMeshShape(_shape, _mesh);
+				if (NULL == shape)
+				{
+					return false;
+				}
+
+				if (0 != key)
+				{
+					m_shapeCache.insert(stl::make_pair(key, shape) );
+				}
+			}
+
+			if (1.0f != _scale.x
+			||  1.0f != _scale.y
+			||  1.0f != _scale.z)
+			{
+				shape = new JPH::ScaledShape(shape, toVec(_scale) );
+			}
+
+			if (!m_bodies[_handle.idx].create(_handle, shape, key, _pos, _quat, _layer, _motion, _activation, _maxVelocity, _flags) )
+			{
+				shape = NULL;
+				shapeCacheRelease(key);
+				return false;
+			}
+
+			return true;
 		}
 
 		void destroyBody(BodyHandle _handle) override
 		{
-			m_bodies[_handle.idx].destroy();
+			BodyRef& br = m_bodies[_handle.idx];
+			const uint64_t key = br.m_shapeKey;
+
+			br.destroy();
+
+			shapeCacheRelease(key);
+		}
+
+		/// Drop cached mesh shape once last body using it is gone.
+		void shapeCacheRelease(uint64_t _key)
+		{
+			if (0 != _key)
+			{
+				ShapeCache::iterator it = m_shapeCache.find(_key);
+				if (it != m_shapeCache.end()
+				&&  1 == it->second->GetRefCount() )
+				{
+					m_shapeCache.erase(it);
+				}
+			}
 		}
 
 		void setPosition(BodyHandle _handle, const bx::Vec3& _pos, Activation::Enum _activation) override
@@ -715,6 +1614,67 @@ namespace max { namespace jolt
 			m_bodies[_handle.idx].addMovement(_position, _rotation, _deltaTime);
 		}
 
+		// Bulk functions are called with physics lock held, physics thread
+		// is not stepping so body locks are not needed.
+
+		void getTransforms(const BodyHandle* _handles, uint32_t _num, bx::Vec3* _positions, bx::Quaternion* _rotations) override
+		{
+			const JPH::BodyInterface& bodyInterface = s_system->GetBodyInterfaceNoLock();
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				JPH::RVec3 pos;
+				JPH::Quat rot;
+				bodyInterface.GetPositionAndRotation(m_bodies[_handles[ii].idx].m_id, pos, rot);
+
+				if (NULL != _positions)
+				{
+					_positions[ii] = fromVec(pos);
+				}
+
+				if (NULL != _rotations)
+				{
+					_rotations[ii] = fromQuat(rot);
+				}
+			}
+		}
+
+		void setPositions(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _positions, Activation::Enum _activation) override
+		{
+			JPH::BodyInterface& bodyInterface = s_system->GetBodyInterfaceNoLock();
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				bodyInterface.SetPosition(m_bodies[_handles[ii].idx].m_id, toVec(_positions[ii]), (JPH::EActivation)_activation);
+			}
+		}
+
+		void addForces(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _forces, Activation::Enum _activation) override
+		{
+			JPH::BodyInterface& bodyInterface = s_system->GetBodyInterfaceNoLock();
+
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				bodyInterface.AddForce(m_bodies[_handles[ii].idx].m_id, toVec(_forces[ii]), (JPH::EActivation)_activation);
+			}
+		}
+
+		uint32_t getActiveBodies(BodyHandle* _handles, uint32_t _max) override
+		{
+			const JPH::BodyInterface& bodyInterface = s_system->GetBodyInterfaceNoLock();
+
+			const uint32_t numActive = s_system->GetNumActiveBodies(JPH::EBodyType::RigidBody);
+			const JPH::BodyID* active = s_system->GetActiveBodiesUnsafe(JPH::EBodyType::RigidBody);
+
+			const uint32_t num = bx::min(numActive, _max);
+			for (uint32_t ii = 0; ii < num; ++ii)
+			{
+				_handles[ii].idx = uint16_t(bodyInterface.GetUserData(active[ii]) );
+			}
+
+			return num;
+		}
+
 		void setFriction(BodyHandle _handle, float _friction) override
 		{
 			m_bodies[_handle.idx].setFriction(_friction);
@@ -735,17 +1695,134 @@ namespace max { namespace jolt
 			return fromVec(s_system->GetGravity());
 		}
 
-		JPH::TempAllocatorImpl* m_allocator;
+		/// State recorder writing into reusable buffer, or reading from user
+		/// memory. JPH::StateRecorderImpl goes through stringstream which is
+		/// too slow for saving state every step.
+		class StateStream final : public JPH::StateRecorder
+		{
+		public:
+			StateStream(stl::vector<uint8_t>& _buffer)
+				: m_buffer(&_buffer)
+				, m_data(NULL)
+				, m_size(0)
+				, m_pos(0)
+				, m_failed(false)
+			{
+				m_buffer->clear();
+			}
+
+			StateStream(const void* _data, uint32_t _size)
+				: m_buffer(NULL)
+				, m_data( (const uint8_t*)_data)
+				, m_size(_size)
+				, m_pos(0)
+				, m_failed(false)
+			{
+			}
+
+			virtual void WriteBytes(const void* _data, size_t _size) override
+			{
+				const uint8_t* data = (const uint8_t*)_data;
+				m_buffer->insert(m_buffer->end(), data, data + _size);
+			}
+
+			virtual void ReadBytes(void* _data, size_t _size) override
+			{
+				if (m_failed
+				||  m_pos + _size > m_size)
+				{
+					bx::memSet(_data, 0, _size);
+					m_failed = true;
+					return;
+				}
+
+				bx::memCopy(_data, &m_data[m_pos], _size);
+				m_pos += uint32_t(_size);
+			}
+
+			virtual bool IsEOF() const override
+			{
+				return m_pos >= m_size;
+			}
+
+			virtual bool IsFailed() const override
+			{
+				return m_failed;
+			}
+
+		private:
+			stl::vector<uint8_t>* m_buffer;
+			const uint8_t* m_data;
+			uint32_t m_size;
+			uint32_t m_pos;
+			bool m_failed;
+		};
+
+		/// Saves active bodies and contacts that involve at least one active
+		/// body.
+		class ActiveStateFilter final : public JPH::StateRecorderFilter
+		{
+		public:
+			virtual bool ShouldSaveBody(const JPH::Body& _body) const override
+			{
+				return _body.IsActive();
+			}
+
+			virtual bool ShouldSaveContact(const JPH::BodyID& _body0, const JPH::BodyID& _body1) const override
+			{
+				const JPH::BodyInterface& bodyInterface = s_system->GetBodyInterfaceNoLock();
+				return bodyInterface.IsActive(_body0) || bodyInterface.IsActive(_body1);
+			}
+		};
+
+		uint32_t saveState(void* _data, uint32_t _size, PhysicsState::Enum _state) override
+		{
+			const ActiveStateFilter filter;
+
+			StateStream stream(m_stateBuffer);
+			s_system->SaveState(
+				  stream
+				, JPH::EStateRecorderState::All
+				, PhysicsState::Active == _state ? &filter : NULL
+				);
+
+			const uint32_t size = uint32_t(m_stateBuffer.size() );
+			if (NULL != _data
+			&&  size <= _size)
+			{
+				bx::memCopy(_data, m_stateBuffer.data(), size);
+			}
+
+			return size;
+		}
+
+		bool restoreState(const void* _data, uint32_t _size) override
+		{
+			StateStream stream(_data, _size);
+			return s_system->RestoreState(stream)
+				&& !stream.IsFailed()
+				;
+		}
+
+		TempAllocator* m_allocator;
 		JPH::JobSystemThreadPool* m_jobSystem;
 
 		JPH::BPLayerInterfaceImpl m_bpli;
-		JPH::ObjectVsBroadPhaseLayerFilterImpl m_ovbplf;
 		JPH::ObjectLayerPairFilterImpl m_olpf;
+		JPH::ObjectVsBroadPhaseLayerFilterImpl m_ovbplf;
 
 		JPH::MyBodyActivationListener m_bodyActivationListener;
 		JPH::MyContactListener m_contactListener;
 
 		BodyRef m_bodies[MAX_CONFIG_MAX_BODIES];
+		uint16_t m_groundQuery[MAX_CONFIG_MAX_BODIES];
+
+		typedef stl::unordered_map<uint64_t, JPH::Ref<JPH::Shape> > ShapeCache;
+		ShapeCache m_shapeCache;
+
+		stl::vector<uint8_t> m_stateBuffer;
+
+		PhysicsStats m_stats[2]; //!< Published and accumulating stats.
 	};
 
 	PhysicsContextJolt* s_physicsJolt;
@@ -27,14 +27,43 @@ namespace max { namespace noop
 			return MAX_PHYSICS_NOOP_NAME;
 		}
 
-		void simulate(const float _dt) override
+		void simulate(const float _dt, uint32_t _collisionSteps) override
 		{
 		}
 
+		void getBodyTransforms(BodyTransform* _transforms) override
+		{
+		}
+
+		void debugDraw(ViewId _viewId) override
+		{
+		}
+
+		void publishEvents() override
+		{
+		}
+
+		const ContactEvent* getContactEvents(uint32_t* _num) override
+		{
+			*_num = 0;
+			return NULL;
+		}
+
+		const ActivationEvent* getActivationEvents(uint32_t* _num) override
+		{
+			*_num = 0;
+			return NULL;
+		}
+
 		void createBody(BodyHandle _handle, CollisionShape::Enum _shape, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags) override
 		{
 		}
 
+		bool createMeshBody(BodyHandle _handle, CollisionShape::Enum _shape, const MeshRef& _mesh, const bx::Vec3& _pos, const bx::Quaternion& _quat, const bx::Vec3& _scale, LayerType::Enum _layer, MotionType::Enum _motion, Activation::Enum _activation, float _maxVelocity, uint8_t _flags) override
+		{
+			return true;
+		}
+
 		void destroyBody(BodyHandle _handle) override
 		{
 		}
@@ -103,6 +132,44 @@ namespace max { namespace noop
 		{
 		}
 
+		void getTransforms(const BodyHandle* _handles, uint32_t _num, bx::Vec3* _positions, bx::Quaternion* _rotations) override
+		{
+		}
+
+		void setPositions(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _positions, Activation::Enum _activation) override
+		{
+		}
+
+		void addForces(const BodyHandle* _handles, uint32_t _num, const bx::Vec3* _forces, Activation::Enum _activation) override
+		{
+		}
+
+		uint32_t getActiveBodies(BodyHandle* _handles, uint32_t _max) override
+		{
+			return 0;
+		}
+
+		void rayCast(const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits) override
+		{
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				_hits[ii] = PhysicsHit();
+			}
+		}
+
+		void shapeCast(CollisionShape::Enum _shape, const bx::Vec3& _scale, const PhysicsRay* _rays, uint32_t _num, PhysicsHit* _hits) override
+		{
+			for (uint32_t ii = 0; ii < _num; ++ii)
+			{
+				_hits[ii] = PhysicsHit();
+			}
+		}
+
+		void overlap(CollisionShape::Enum _shape, const bx::Vec3& _scale, const bx::Vec3* _positions, uint32_t _num, BodyHandle* _bodies, uint32_t _maxBodies, uint32_t* _numBodies) override
+		{
+			bx::memSet(_numBodies, 0, _num*sizeof(uint32_t) );
+		}
+
 		void setFriction(BodyHandle _handle, float _friction) override
 		{
 		}
@@ -120,6 +187,21 @@ namespace max { namespace noop
 		{
 			return { 0.0f, 0.0f, 0.0f };
 		}
+
+		void getStats(PhysicsStats& _stats) override
+		{
+			bx::memSet(&_stats, 0, sizeof(PhysicsStats) );
+		}
+
+		uint32_t saveState(void* _data, uint32_t _size, PhysicsState::Enum _state) override
+		{
+			return 0;
+		}
+
+		bool restoreState(const void* _data, uint32_t _size) override
+		{
+			return false;
+		}
 	};
 
 	static PhysicsContextNOOP* s_physicsNOOP;
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#include <max/max.h>
+
+#include <bx/commandline.h>
+#include <bx/string.h>
+#include <bx/timer.h>
+
+#include <stdio.h>
+
+// Headless ECS benchmark, built with noop entry and run with noop renderer.
+// Results are written to stdout as JSON:
+//
+//   { "benchmark": "ecs", "results": [ { "name": ..., "entities": ..., "ops": ..., "totalNs": ..., "nsPerOp": ... }, ... ] }
+//
+// Options:
+//   --max <num>   Largest entity count to run (default: 1000000).
+
+struct Position
+{
+	float x, y, z;
+};
+
+struct Velocity
+{
+	float x, y, z;
+};
+
+// Total number of operations per repeated benchmark, keeps small entity
+// counts from finishing below timer resolution.
+static const uint32_t kWorkPerBench = 1<<22;
+
+static bool s_first = true;
+static bool s_failed = false;
+
+static void report(const char* _name, uint32_t _entities, uint64_t _ops, int64_t _ticks)
+{
+	const double totalNs = double(_ticks) * 1.0e9 / double(bx::getHPFrequency() );
+
+	printf("%s\n\t\t{ \"name\": \"%s\", \"entities\": %u, \"ops\": %llu, \"totalNs\": %.0f, \"nsPerOp\": %.3f }"
+		, s_first ? "" : ","
+		, _name
+		, _entities
+		, (unsigned long long)_ops
+		, totalNs
+		, totalNs / double(bx::max<uint64_t>(_ops, 1) )
+		);
+
+	s_first = false;
+}
+
+static uint32_t getRepeat(uint32_t _num)
+{
+	return bx::max<uint32_t>(1, kWorkPerBench / _num);
+}
+
+// Query results live in per-frame arena that is reset by `max::frame`. Timed
+// queries run one per frame, with frame ended outside of timed region, and
+// any query that didn't fit arena fails benchmark since it measured heap
+// allocation instead of ECS.
+static void endFrame(const char* _name)
+{
+	if (0 != max::getStats()->ecs.numQueryOverflows)
+	{
+		fprintf(stderr, "%s: Query arena overflow during timed region.\n", _name);
+		s_failed = true;
+	}
+
+	max::frame();
+}
+
+static void integrate(max::EntityHandle _entity, void* _userData)
+{
+	Position* pos = max::getComponent<Position>(_entity, max::Access::ReadWrite);
+	const Velocity* vel = max::getComponent<Velocity>(_entity, max::Access::Read);
+
+	pos->x += vel->x;
+	pos->y += vel->y;
+	pos->z += vel->z;
+
+	++*(uint32_t*)_userData;
+}
+
+static void integrateChunk(uint32_t _num, const max::EntityHandle* /*_entities*/, Position* _pos, Velocity* _vel, void* _userData)
+{
+	for (uint32_t ii = 0; ii < _num; ++ii)
+	{
+		_pos[ii].x += _vel[ii].x;
+		_pos[ii].y += _vel[ii].y;
+		_pos[ii].z += _vel[ii].z;
+	}
+
+	*(uint32_t*)_userData += _num;
+}
+
+static void benchEcs(uint32_t _num)
+{
+	max::EntityHandle* entities = new max::EntityHandle[_num];
+
+	// createEntity + createComponent + addComponent per entity.
+	{
+		int64_t elapsed = -bx::getHPCounter();
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			const max::EntityHandle entity = max::createEntity();
+			max::addComponent<Position>(entity, max::createComponent<Position>({ float(ii), 0.0f, 0.0f }) );
+			max::addComponent<Velocity>(entity, max::createComponent<Velocity>({ 1.0f, 2.0f, 3.0f }) );
+			entities[ii] = entity;
+		}
+
+		elapsed += bx::getHPCounter();
+		report("createEntity", _num, _num, elapsed);
+	}
+
+	const max::ComponentTypeHandle types[] =
+	{
+		max::getComponentType<Position>(),
+		max::getComponentType<Velocity>(),
+	};
+
+	// Warm up, grows query arena to fit largest query result.
+	max::queryChunks(types, BX_COUNTOF(types) );
+	max::queryEntities(types, BX_COUNTOF(types) );
+	max::frame();
+
+	// queryEntities, cost of building entity list.
+	{
+		const uint32_t repeat = getRepeat(_num);
+
+		int64_t elapsed = 0;
+
+		uint32_t total = 0;
+		for (uint32_t ii = 0; ii < repeat; ++ii)
+		{
+			elapsed -= bx::getHPCounter();
+			total += max::queryEntities(types, BX_COUNTOF(types) )->m_num;
+			elapsed += bx::getHPCounter();
+
+			endFrame("queryEntities");
+		}
+
+		report("queryEntities", _num, repeat, elapsed);
+
+		BX_ASSERT(total == repeat*_num, "Query returned %d entities, expected %d.", total, repeat*_num); BX_UNUSED(total);
+	}
+
+	// System::each, per entity callback with getComponent.
+	{
+		const uint32_t repeat = getRepeat(_num);
+
+		max::System<Position, Velocity> system;
+
+		int64_t elapsed = 0;
+
+		uint32_t count = 0;
+		for (uint32_t ii = 0; ii < repeat; ++ii)
+		{
+			elapsed -= bx::getHPCounter();
+			system.each(0, integrate, &count);
+			elapsed += bx::getHPCounter();
+
+			endFrame("System::each");
+		}
+
+		report("System::each", _num, count, elapsed);
+	}
+
+	// System::eachChunk, component arrays per chunk.
+	{
+		const uint32_t repeat = getRepeat(_num);
+
+		max::System<Position, Velocity> system;
+
+		int64_t elapsed = 0;
+
+		uint32_t count = 0;
+		for (uint32_t ii = 0; ii < repeat; ++ii)
+		{
+			elapsed -= bx::getHPCounter();
+			system.eachChunk(integrateChunk, &count);
+			elapsed += bx::getHPCounter();
+
+			endFrame("System::eachChunk");
+		}
+
+		report("System::eachChunk", _num, count, elapsed);
+	}
+
+	// getComponent in random entity order.
+	{
+		uint32_t seed = 0x9e3779b9;
+		for (uint32_t ii = _num - 1; ii > 0; --ii)
+		{
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+
+			const uint32_t jj = seed % (ii + 1);
+			bx::swap(entities[ii], entities[jj]);
+		}
+
+		const uint32_t repeat = getRepeat(_num);
+
+		int64_t elapsed = -bx::getHPCounter();
+
+		float sum = 0.0f;
+		for (uint32_t ii = 0; ii < repeat; ++ii)
+		{
+			for (uint32_t jj = 0; jj < _num; ++jj)
+			{
+				sum += max::getComponent<Position>(entities[jj], max::Access::Read)->x;
+			}
+		}
+
+		elapsed += bx::getHPCounter();
+		report("getComponent", _num, uint64_t(repeat)*_num, elapsed);
+
+		BX_UNUSED(sum);
+	}
+
+	// destroy per entity.
+	{
+		int64_t elapsed = -bx::getHPCounter();
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			max::destroy(entities[ii]);
+		}
+
+		elapsed += bx::getHPCounter();
+		report("destroyEntity", _num, _num, elapsed);
+	}
+
+	// createEntities + range destroy.
+	{
+		const Position pos = { 0.0f, 0.0f, 0.0f };
+		const Velocity vel = { 1.0f, 2.0f, 3.0f };
+
+		max::EntityPrototype prototype;
+		prototype
+			.begin()
+			.add(pos)
+			.add(vel)
+			;
+
+		int64_t elapsed = -bx::getHPCounter();
+		const max::EntityHandle first = max::createEntities(_num, prototype);
+		elapsed += bx::getHPCounter();
+		report("createEntities", _num, _num, elapsed);
+
+		elapsed = -bx::getHPCounter();
+		max::destroy(first, _num);
+		elapsed += bx::getHPCounter();
+		report("destroyEntities", _num, _num, elapsed);
+	}
+
+	delete [] entities;
+}
+
+int _main_(int _argc, char** _argv)
+{
+	bx::CommandLine cmdLine(_argc, _argv);
+
+	uint32_t maxEntities = 1000000;
+	if (const char* str = cmdLine.findOption("max") )
+	{
+		bx::fromString(&maxEntities, str);
+	}
+
+	max::Init init;
+	init.rendererType = max::RendererType::Noop;
+	init.physicsType  = max::PhysicsType::Noop;
+	init.vendorId     = MAX_PCI_ID_NONE;
+	if (!max::init(init) )
+	{
+		fprintf(stderr, "Failed to initialize max.\n");
+		return bx::kExitFailure;
+	}
+
+	printf("{\n\t\"benchmark\": \"ecs\",\n\t\"results\": [");
+
+	for (uint32_t num = 1000; num <= maxEntities; num *= 10)
+	{
+		benchEcs(num);
+		max::frame();
+	}
+
+	printf("\n\t]\n}\n");
+
+	max::shutdown();
+
+	return s_failed ? bx::kExitFailure : bx::kExitSuccess;
+}
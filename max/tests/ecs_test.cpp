@@ -0,0 +1,292 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#include "test.h"
+
+struct Position
+{
+	float x, y, z;
+};
+
+struct Velocity
+{
+	float x, y, z;
+};
+
+struct Health
+{
+	int32_t hp;
+};
+
+struct Marker
+{
+	uint32_t id;
+};
+
+static uint32_t countEntities(max::ComponentTypeHandle _type)
+{
+	return max::queryEntities(&_type, 1)->m_num;
+}
+
+TEST_CASE("ECS entity prototype", "[ecs]")
+{
+	const max::ComponentTypeHandle position = max::getComponentType<Position>();
+	const uint32_t numBefore = countEntities(position);
+
+	const Position pos = { 1.0f, 2.0f, 3.0f };
+	const Velocity vel = { 4.0f, 5.0f, 6.0f };
+
+	// Duplicate component type is rejected, and leaves no archetype behind.
+	{
+		max::EntityPrototype prototype;
+		prototype
+			.begin()
+			.add(pos)
+			.add(vel)
+			.add(pos)
+			;
+
+		REQUIRE(!max::isValid(max::createEntities(16, prototype) ) );
+		REQUIRE(numBefore == countEntities(position) );
+	}
+
+	// Size not matching registered component type is rejected.
+	{
+		max::EntityPrototype prototype;
+		prototype
+			.begin()
+			.add(position, &pos, sizeof(Position) - sizeof(float) )
+			;
+
+		REQUIRE(!max::isValid(max::createEntities(16, prototype) ) );
+		REQUIRE(numBefore == countEntities(position) );
+	}
+
+	// Valid prototype creates consecutive entities with initial data.
+	{
+		max::EntityPrototype prototype;
+		prototype
+			.begin()
+			.add(pos)
+			.add(vel)
+			;
+
+		const max::EntityHandle first = max::createEntities(16, prototype);
+		REQUIRE(max::isValid(first) );
+		REQUIRE(numBefore + 16 == countEntities(position) );
+
+		for (uint32_t ii = 0; ii < 16; ++ii)
+		{
+			const max::EntityHandle entity = { first.idx + ii };
+			const Velocity* data = max::getComponent<Velocity>(entity);
+			REQUIRE( (NULL != data && 5.0f == data->y) );
+		}
+
+		max::destroy(first, 16);
+		REQUIRE(numBefore == countEntities(position) );
+	}
+
+	max::frame();
+}
+
+TEST_CASE("ECS entity command buffer", "[ecs]")
+{
+	const max::ComponentTypeHandle health = max::getComponentType<Health>();
+	const uint32_t numBefore = countEntities(health);
+
+	// Temporary handle is remapped to created entity on playback.
+	{
+		max::EntityCommandBuffer* commands = max::beginEntityCommands();
+		REQUIRE( (NULL != commands) );
+
+		const max::EntityHandle temp = commands->createEntity();
+		commands->addComponent(temp, Health{ 42 });
+		max::end(commands);
+
+		// Second end is ignored, commands are played back only once.
+		max::end(commands);
+
+		max::frame();
+
+		max::EntityQuery* query = max::queryEntities(&health, 1);
+		REQUIRE(numBefore + 1 == query->m_num);
+
+		for (uint32_t ii = 0; ii < query->m_num; ++ii)
+		{
+			const Health* data = max::getComponent<Health>(query->m_entities[ii]);
+			REQUIRE( (NULL != data && 42 == data->hp) );
+			max::destroy(query->m_entities[ii]);
+		}
+	}
+
+	// Temporary handle used in other command buffer is ignored.
+	{
+		max::EntityCommandBuffer* commandsA = max::beginEntityCommands();
+		max::EntityCommandBuffer* commandsB = max::beginEntityCommands();
+
+		const max::EntityHandle temp = commandsA->createEntity();
+		commandsA->addComponent(temp, Marker{ 1 });
+		commandsB->addComponent(temp, Health{ 7 });
+
+		max::end(commandsA);
+		max::end(commandsB);
+
+		max::frame();
+
+		REQUIRE(numBefore == countEntities(health) );
+
+		// Entity created by first command buffer exists without component
+		// from second one, destroy it so later tests start from clean state.
+		const max::ComponentTypeHandle marker = max::getComponentType<Marker>();
+
+		max::EntityQuery* query = max::queryEntities(&marker, 1);
+		REQUIRE(1 == query->m_num);
+		REQUIRE( (NULL == max::getComponent<Health>(query->m_entities[0]) ) );
+
+		max::destroy(query->m_entities[0]);
+		REQUIRE(0 == countEntities(marker) );
+	}
+
+	max::frame();
+}
+
+TEST_CASE("ECS change filter", "[ecs]")
+{
+	const max::ComponentTypeHandle types[] =
+	{
+		max::getComponentType<Position>(),
+		max::getComponentType<Velocity>(),
+	};
+
+	const Position pos = { 0.0f, 0.0f, 0.0f };
+	const Velocity vel = { 1.0f, 1.0f, 1.0f };
+
+	max::EntityPrototype prototype;
+	prototype
+		.begin()
+		.add(pos)
+		.add(vel)
+		;
+
+	const max::EntityHandle first = max::createEntities(8, prototype);
+	REQUIRE(max::isValid(first) );
+
+	// Changes made after `max::frame` returns are tagged with next frame.
+	const uint32_t since = max::frame() + 1;
+	REQUIRE(0 == max::queryChangedEntities(types, BX_COUNTOF(types), since)->m_num);
+
+	// Read access doesn't mark component as changed.
+	const max::EntityHandle second = { first.idx + 1 };
+	REQUIRE( (NULL != max::getComponent<Position>(second) ) );
+	REQUIRE( (NULL != max::getComponent<Velocity>(second, max::Access::Read) ) );
+	REQUIRE(0 == max::queryChangedEntities(types, BX_COUNTOF(types), since)->m_num);
+
+	// Write access and `markChanged` do.
+	const max::EntityHandle third = { first.idx + 2 };
+	max::getComponent<Position>(second, max::Access::Write)->x = 1.0f;
+	max::markChanged(third, types[1]);
+
+	max::EntityQuery* query = max::queryChangedEntities(types, BX_COUNTOF(types), since);
+	REQUIRE(2 == query->m_num);
+
+	for (uint32_t ii = 0; ii < query->m_num; ++ii)
+	{
+		REQUIRE( (second.idx == query->m_entities[ii].idx || third.idx == query->m_entities[ii].idx) );
+	}
+
+	// Zero returns all entities.
+	REQUIRE(8 == max::queryChangedEntities(types, BX_COUNTOF(types), 0)->m_num);
+
+	max::destroy(first, 8);
+	max::frame();
+}
+
+TEST_CASE("ECS handle reuse", "[ecs]")
+{
+	const max::ComponentTypeHandle health = max::getComponentType<Health>();
+	const uint32_t numBefore = countEntities(health);
+
+	const Health hp = { 100 };
+
+	max::EntityPrototype prototype;
+	prototype
+		.begin()
+		.add(hp)
+		;
+
+	// Handle of destroyed entity is not reused within same frame.
+	{
+		const max::EntityHandle a = max::createEntities(1, prototype);
+		max::destroy(a);
+
+		const max::EntityHandle b = max::createEntities(1, prototype);
+		REQUIRE(max::isValid(b) );
+		REQUIRE(a.idx != b.idx);
+
+		max::EntityQuery* query = max::queryEntities(&health, 1);
+		REQUIRE(numBefore + 1 == query->m_num);
+
+		for (uint32_t ii = 0; ii < query->m_num; ++ii)
+		{
+			REQUIRE(a.idx != query->m_entities[ii].idx);
+		}
+
+		max::destroy(b);
+	}
+
+	// Same for consecutive handle ranges.
+	{
+		const max::EntityHandle first = max::createEntities(4, prototype);
+		max::destroy(first, 4);
+
+		const max::EntityHandle second = max::createEntities(4, prototype);
+		REQUIRE(max::isValid(second) );
+		REQUIRE( (second.idx >= first.idx + 4 || second.idx + 4 <= first.idx) );
+		REQUIRE(numBefore + 4 == countEntities(health) );
+
+		max::destroy(second, 4);
+	}
+
+	max::frame();
+
+	// Destroyed handles are held until `max::frame`, and handed out again
+	// after it.
+	{
+		const max::EntityHandle a = max::createEntity();
+		const max::EntityHandle b = max::createEntity();
+		REQUIRE(max::isValid(a) );
+		REQUIRE(max::isValid(b) );
+
+		max::destroy(a);
+		max::destroy(b);
+
+		const max::EntityHandle c = max::createEntity();
+		REQUIRE(max::isValid(c) );
+		REQUIRE(a.idx != c.idx);
+		REQUIRE(b.idx != c.idx);
+		max::destroy(c);
+
+		max::frame();
+
+		const max::EntityHandle d = max::createEntity();
+		const max::EntityHandle e = max::createEntity();
+		REQUIRE( (a.idx == d.idx || b.idx == d.idx || c.idx == d.idx) );
+		REQUIRE( (a.idx == e.idx || b.idx == e.idx || c.idx == e.idx) );
+
+		// Reused handle refers to new entity, not to destroyed one.
+		max::addComponent<Health>(d, max::createComponent<Health>({ 100 }) );
+
+		const Health* data = max::getComponent<Health>(d);
+		REQUIRE( (NULL != data && 100 == data->hp) );
+		REQUIRE( (NULL == max::getComponent<Health>(e) ) );
+
+		max::destroy(d);
+		max::destroy(e);
+	}
+
+	REQUIRE(numBefore == countEntities(health) );
+
+	max::frame();
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#include "test.h"
+
+#include <stdio.h>
+
+// Headless test runner, built with noop entry. All test cases share single
+// max instance running noop renderer and physics.
+int _main_(int _argc, char** _argv)
+{
+	max::Init init;
+	init.rendererType = max::RendererType::Noop;
+	init.physicsType  = max::PhysicsType::Noop;
+	init.vendorId     = MAX_PCI_ID_NONE;
+	if (!max::init(init) )
+	{
+		fprintf(stderr, "Failed to initialize max.\n");
+		return bx::kExitFailure;
+	}
+
+	const int32_t result = Catch::Session().run(_argc, _argv);
+
+	max::shutdown();
+
+	return result;
+}
@@ -0,0 +1,18 @@
+/*
+ * Copyright 2024 Marcus Madland. All rights reserved.
+ * License: https://github.com/marcusmadland/max/blob/main/LICENSE
+ */
+
+#ifndef MAX_TEST_H_HEADER_GUARD
+#define MAX_TEST_H_HEADER_GUARD
+
+#include <bx/bx.h>
+
+BX_PRAGMA_DIAGNOSTIC_PUSH();
+BX_PRAGMA_DIAGNOSTIC_IGNORED_MSVC(4312); // warning C4312 : 'reinterpret_cast' : conversion from 'int' to 'const char *' of greater size
+#include <catch/catch_amalgamated.hpp>
+BX_PRAGMA_DIAGNOSTIC_POP();
+
+#include <max/max.h>
+
+#endif // MAX_TEST_H_HEADER_GUARD
@@ -26,7 +26,7 @@ namespace stl = tinystl;
 #include <cgltf/cgltf.h>
 
 #define MAX_GEOMETRYC_VERSION_MAJOR 1
-#define MAX_GEOMETRYC_VERSION_MINOR 0
+#define MAX_GEOMETRYC_VERSION_MINOR 2
 
 #if 0
 #	define BX_TRACE(_format, ...) \
@@ -126,6 +126,14 @@ struct Primitive
 
 typedef stl::vector<Primitive> PrimitiveArray;
 
+struct Lod
+{
+	float m_error; //!< Object space simplification error.
+	stl::vector<uint32_t> m_indices;
+};
+
+typedef stl::vector<Lod> LodArray;
+
 struct Axis
 {
 	enum Enum
@@ -185,22 +193,33 @@ struct Mesh
 
 static uint32_t s_obbSteps = 17;
 
-constexpr uint32_t kChunkVertexBuffer = BX_MAKEFOURCC('V', 'B', ' ', 0x1);
-constexpr uint32_t kChunkVertexBufferCompressed = BX_MAKEFOURCC('V', 'B', 'C', 0x0);
+// Vertex buffer chunks carry 32-bit vertex count, index buffer chunk version
+// selects 16-bit or 32-bit indices.
+constexpr uint32_t kChunkVertexBuffer = BX_MAKEFOURCC('V', 'B', ' ', 0x2);
+constexpr uint32_t kChunkVertexBufferCompressed = BX_MAKEFOURCC('V', 'B', 'C', 0x1);
 constexpr uint32_t kChunkIndexBuffer = BX_MAKEFOURCC('I', 'B', ' ', 0x0);
+constexpr uint32_t kChunkIndexBuffer32 = BX_MAKEFOURCC('I', 'B', ' ', 0x1);
 constexpr uint32_t kChunkIndexBufferCompressed = BX_MAKEFOURCC('I', 'B', 'C', 0x1);
+constexpr uint32_t kChunkIndexBufferCompressed32 = BX_MAKEFOURCC('I', 'B', 'C', 0x2);
 constexpr uint32_t kChunkPrimitive = BX_MAKEFOURCC('P', 'R', 'I', 0x0);
+constexpr uint32_t kChunkLod = BX_MAKEFOURCC('L', 'O', 'D', 0x0);
 
-void optimizeVertexCache(uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices)
+// Maximum number of vertices per group with 16-bit indices.
+constexpr uint32_t kMaxVertices16 = 65533;
+
+// Maximum number of simplified LODs per group.
+constexpr uint32_t kMaxLods = 8;
+
+void optimizeVertexCache(uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices)
 {
-	uint16_t* newIndexList = new uint16_t[_numIndices];
+	uint32_t* newIndexList = new uint32_t[_numIndices];
 	meshopt_optimizeVertexCache(newIndexList, _indices, _numIndices, _numVertices);
-	bx::memCopy(_indices, newIndexList, _numIndices * 2);
+	bx::memCopy(_indices, newIndexList, _numIndices * sizeof(uint32_t));
 	delete[] newIndexList;
 }
 
 uint32_t optimizeVertexFetch(
-	uint16_t* _indices
+	uint32_t* _indices
 	, uint32_t _numIndices
 	, uint8_t* _vertexData
 	, uint32_t _numVertices
@@ -215,11 +234,72 @@ uint32_t optimizeVertexFetch(
 	return uint32_t(vertexCount);
 }
 
+void simplify(
+	LodArray& _lods
+	, const uint32_t* _indices
+	, uint32_t _numIndices
+	, const uint8_t* _vertexData
+	, uint32_t _numVertices
+	, uint16_t _stride
+	, uint32_t _numLods
+	, float _maxError
+)
+{
+	// Position is first vertex attribute.
+	const float* positions = (const float*)_vertexData;
+	const float scale = meshopt_simplifyScale(positions, _numVertices, _stride);
+
+	uint32_t* indices = new uint32_t[_numIndices];
+	uint32_t prevNumIndices = _numIndices;
+
+	// Every LOD halves triangle count of previous one and is simplified from
+	// full detail group, so error is relative to original. Group borders are
+	// locked to avoid cracks between groups.
+	for (uint32_t ii = 0; ii < _numLods; ++ii)
+	{
+		const uint32_t target = (_numIndices >> (ii + 1) ) / 3 * 3;
+
+		float error = 0.0f;
+		const uint32_t numIndices = uint32_t(meshopt_simplify(
+			  indices
+			, _indices
+			, _numIndices
+			, positions
+			, _numVertices
+			, _stride
+			, target
+			, _maxError
+			, meshopt_SimplifyLockBorder
+			, &error
+			) );
+
+		// Stop once simplification can't reduce triangle count any further.
+		if (0 == numIndices
+		||  numIndices >= prevNumIndices * 9 / 10)
+		{
+			break;
+		}
+
+		meshopt_optimizeVertexCache(indices, indices, numIndices, _numVertices);
+
+		Lod lod;
+		lod.m_error = error * scale;
+		lod.m_indices.resize(numIndices);
+		bx::memCopy(lod.m_indices.data(), indices, numIndices * sizeof(uint32_t) );
+		_lods.push_back(lod);
+
+		prevNumIndices = numIndices;
+	}
+
+	delete[] indices;
+}
+
 void writeCompressedIndices(
 	bx::WriterI* _writer
-	, const uint16_t* _indices
+	, const uint32_t* _indices
 	, uint32_t _numIndices
 	, uint32_t _numVertices
+	, uint32_t _indexSize
 	, bx::Error* _err
 )
 {
@@ -229,9 +309,9 @@ void writeCompressedIndices(
 	size_t compressedSize = meshopt_encodeIndexBuffer(compressedIndices, maxSize, _indices, _numIndices);
 
 	bx::printf("Indices uncompressed: %10d, compressed: %10d, ratio: %0.2f%%\n"
-		, _numIndices * 2
+		, _numIndices * _indexSize
 		, (uint32_t)compressedSize
-		, 100.0f - float(compressedSize) / float(_numIndices * 2) * 100.0f
+		, 100.0f - float(compressedSize) / float(_numIndices * _indexSize) * 100.0f
 	);
 
 	bx::write(_writer, (uint32_t)compressedSize, _err);
@@ -265,7 +345,7 @@ void writeCompressedVertices(
 	free(compressedVertices);
 }
 
-void calcTangents(void* _vertices, uint16_t _numVertices, max::VertexLayout _layout, const uint16_t* _indices, uint32_t _numIndices)
+void calcTangents(void* _vertices, uint32_t _numVertices, max::VertexLayout _layout, const uint32_t* _indices, uint32_t _numIndices)
 {
 	struct PosTexcoord
 	{
@@ -288,7 +368,7 @@ void calcTangents(void* _vertices, uint16_t _numVertices, max::VertexLayout _lay
 
 	for (uint32_t ii = 0, num = _numIndices / 3; ii < num; ++ii)
 	{
-		const uint16_t* indices = &_indices[ii * 3];
+		const uint32_t* indices = &_indices[ii * 3];
 		uint32_t i0 = indices[0];
 		uint32_t i1 = indices[1];
 		uint32_t i2 = indices[2];
@@ -399,11 +479,12 @@ void write(
 	, const uint8_t* _vertices
 	, uint32_t _numVertices
 	, const max::VertexLayout& _layout
-	, const uint16_t* _indices
+	, const uint32_t* _indices
 	, uint32_t _numIndices
 	, bool _compress
 	, const stl::string& _material
 	, const PrimitiveArray& _primitives
+	, const LodArray& _lods
 	, bx::Error* _err
 )
 {
@@ -419,7 +500,7 @@ void write(
 
 		write(_writer, _layout);
 
-		write(_writer, uint16_t(_numVertices), _err);
+		write(_writer, _numVertices, _err);
 		writeCompressedVertices(_writer, _vertices, _numVertices, uint16_t(stride), _err);
 	}
 	else
@@ -429,22 +510,76 @@ void write(
 
 		write(_writer, _layout, _err);
 
-		write(_writer, uint16_t(_numVertices), _err);
+		write(_writer, _numVertices, _err);
 		write(_writer, _vertices, _numVertices * stride, _err);
 	}
 
+	// 16-bit indices whenever group fits, 32-bit only for large groups.
+	const bool index32 = _numVertices > UINT16_MAX;
+
 	if (_compress)
 	{
-		write(_writer, kChunkIndexBufferCompressed, _err);
+		write(_writer, index32 ? kChunkIndexBufferCompressed32 : kChunkIndexBufferCompressed, _err);
 		write(_writer, _numIndices, _err);
 
-		writeCompressedIndices(_writer, _indices, _numIndices, _numVertices, _err);
+		writeCompressedIndices(_writer, _indices, _numIndices, _numVertices, index32 ? 4 : 2, _err);
+	}
+	else if (index32)
+	{
+		write(_writer, kChunkIndexBuffer32, _err);
+		write(_writer, _numIndices, _err);
+		write(_writer, _indices, _numIndices * sizeof(uint32_t), _err);
 	}
 	else
 	{
+		uint16_t* indices16 = new uint16_t[_numIndices];
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			indices16[ii] = uint16_t(_indices[ii]);
+		}
+
 		write(_writer, kChunkIndexBuffer, _err);
 		write(_writer, _numIndices, _err);
-		write(_writer, _indices, _numIndices * 2, _err);
+		write(_writer, indices16, _numIndices * sizeof(uint16_t), _err);
+
+		delete[] indices16;
+	}
+
+	// LOD index buffers are left uncompressed so they can be referenced
+	// straight from mapped file, LODs cover whole group.
+	if (!_lods.empty() )
+	{
+		const uint8_t indexSize = index32 ? 4 : 2;
+
+		write(_writer, kChunkLod, _err);
+		write(_writer, uint8_t(_lods.size() ), _err);
+		write(_writer, indexSize, _err);
+
+		for (LodArray::const_iterator lodIt = _lods.begin(); lodIt != _lods.end(); ++lodIt)
+		{
+			const Lod& lod = *lodIt;
+			const uint32_t numIndices = uint32_t(lod.m_indices.size() );
+
+			write(_writer, lod.m_error, _err);
+			write(_writer, numIndices, _err);
+
+			if (index32)
+			{
+				write(_writer, lod.m_indices.data(), numIndices * sizeof(uint32_t), _err);
+			}
+			else
+			{
+				uint16_t* indices16 = new uint16_t[numIndices];
+				for (uint32_t ii = 0; ii < numIndices; ++ii)
+				{
+					indices16[ii] = uint16_t(lod.m_indices[ii]);
+				}
+
+				write(_writer, indices16, numIndices * sizeof(uint16_t), _err);
+
+				delete[] indices16;
+			}
+		}
 	}
 
 	write(_writer, kChunkPrimitive, _err);
@@ -1281,6 +1416,10 @@ void help(const char* _error = NULL)
 		"      --tangent            Calculate tangent vectors. (packing mode is the same as normal)\n"
 		"      --barycentric        Adds barycentric vertex attribute. (Packed in max::Attrib::Color1)\n"
 		"  -c, --compress           Compress indices.\n"
+		"      --index32            Allow more than 65533 vertices per group, large groups use 32-bit indices.\n"
+		"      --lod <num>          Number of simplified LODs per group, each with half the triangles of previous one.\n"
+		"           Defaults to 0, at most 8.\n"
+		"      --lod-error <num>    Maximum simplification error relative to mesh extents. Defaults to 0.05.\n"
 		"      --[l/r]h-up+[y/z]	  Coordinate system. Defaults to '--lh-up+y' — Left-Handed +Y is up.\n"
 
 		"\n"
@@ -1334,6 +1473,14 @@ int main(int _argc, const char* _argv[])
 	}
 
 	bool compress = cmdLine.hasArg('c', "compress");
+	bool index32 = cmdLine.hasArg("index32");
+
+	uint32_t numLods = 0;
+	cmdLine.hasArg(numLods, '\0', "lod");
+	numLods = bx::uint32_min(numLods, kMaxLods);
+
+	float lodError = 0.05f;
+	cmdLine.hasArg(lodError, '\0', "lod-error");
 
 	cmdLine.hasArg(s_obbSteps, '\0', "obb");
 	s_obbSteps = bx::uint32_min(bx::uint32_max(s_obbSteps, 1), 90);
@@ -1578,7 +1725,7 @@ int main(int _argc, const char* _argv[])
 
 	uint32_t stride = layout.getStride();
 	uint8_t* vertexData = new uint8_t[mesh.m_triangles.size() * 3 * stride];
-	uint16_t* indexData = new uint16_t[mesh.m_triangles.size() * 3];
+	uint32_t* indexData = new uint32_t[mesh.m_triangles.size() * 3];
 	int32_t numVertices = 0;
 	int32_t numIndices = 0;
 
@@ -1587,9 +1734,15 @@ int main(int _argc, const char* _argv[])
 	int32_t writtenIndices = 0;
 
 	uint8_t* vertices = vertexData;
-	uint16_t* indices = indexData;
+	uint32_t* indices = indexData;
 
-	const uint32_t tableSize = 65536 * 2;
+	const uint32_t maxVertices = index32 ? UINT32_MAX - 2 : kMaxVertices16;
+
+	// Vertex dedup table must have room for all vertices of single group.
+	const uint32_t tableSize = index32
+		? bx::uint32_max(65536 * 2, bx::uint32_nextpow2(uint32_t(mesh.m_triangles.size() * 3) ) * 2)
+		: 65536 * 2
+		;
 	const uint32_t hashmod = tableSize - 1;
 	uint32_t* table = new uint32_t[tableSize];
 	bx::memSet(table, 0xff, tableSize * sizeof(uint32_t));
@@ -1597,6 +1750,7 @@ int main(int _argc, const char* _argv[])
 	stl::string material = mesh.m_groups.empty() ? "" : mesh.m_groups.begin()->m_material;
 
 	PrimitiveArray primitives;
+	LodArray lods;
 
 	bx::FileWriter writer;
 	if (!bx::open(&writer, outFilePath))
@@ -1629,7 +1783,7 @@ int main(int _argc, const char* _argv[])
 		{
 			if (0 != bx::strCmp(material.c_str(), groupIt->m_material.c_str())
 				|| sentinel
-				|| 65533 <= numVertices)
+				|| maxVertices <= uint32_t(numVertices) )
 			{
 				prim.m_numVertices = numVertices - prim.m_startVertex;
 				prim.m_numIndices = numIndices - prim.m_startIndex;
@@ -1641,7 +1795,7 @@ int main(int _argc, const char* _argv[])
 
 				if (hasTangent)
 				{
-					calcTangents(vertexData, uint16_t(numVertices), layout, indexData, numIndices);
+					calcTangents(vertexData, numVertices, layout, indexData, numIndices);
 				}
 
 				triReorderElapsed -= bx::getHPCounter();
@@ -1656,6 +1810,12 @@ int main(int _argc, const char* _argv[])
 
 				triReorderElapsed += bx::getHPCounter();
 
+				if (0 < numLods
+				&&  0 < numIndices)
+				{
+					simplify(lods, indexData, numIndices, vertexData, numVertices, uint16_t(stride), numLods, lodError);
+				}
+
 				if (0 < numVertices
 					&& 0 < numIndices)
 				{
@@ -1668,10 +1828,12 @@ int main(int _argc, const char* _argv[])
 						, compress
 						, material
 						, primitives
+						, lods
 						, &err
 					);
 				}
 				primitives.clear();
+				lods.clear();
 
 				bx::memSet(table, 0xff, tableSize * sizeof(uint32_t));
 
@@ -1786,7 +1948,7 @@ int main(int _argc, const char* _argv[])
 					exit(bx::kExitFailure);
 				}
 
-				*indices++ = (uint16_t)vertexIndex;
+				*indices++ = vertexIndex;
 				++numIndices;
 			}
 		}